@@ -13,9 +13,29 @@
 #include <math.h>
 #include <time.h>
 #include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+
+#include "tsp.h"
 
 //Constantes
 #define BUILDMATRIX false
+#ifndef HUGEPAGES
+#define HUGEPAGES false         // Áreas de trabalho em páginas grandes, quando disponíveis
+#endif
+#define PAGINA_GRANDE (2 << 20) // Tamanho da página grande (2MB)
+#define ALINHAMENTO 64          // Alinhamento dos vetores da área de trabalho (linha de cache)
+#define GPX_ELITE 5     // Quantidade de rotas mantidas no conjunto elite
+#define GPX_PERIODO 10  // Intervalo (em execuções) entre as recombinações GPX
+#define CANDIDATOS 10   // Vizinhos mais próximos de cada vértice no grafo candidato
+#define LB_ITERACOES 100   // Iterações do subgradiente de Held-Karp
+#define JANELA_MAX 12      // Maior janela da pós-otimização exata (2^(k-2) estados por vértice)
+#define JANELA_DP 10       // Janela utilizada na pós-otimização da melhor rota
+#define TRECHOS_MAX 64     // Trechos alterados registrados por iteração do IMPROVE
 
 
 //Definição as estruturas
@@ -26,27 +46,172 @@ typedef struct
   float z;
 } Coordenada;
 
+// As coordenadas do chamador da biblioteca são usadas diretamente como Coordenada
+_Static_assert(sizeof(Coordenada) == 3 * sizeof(float), "Coordenada deve ter 3 floats contiguos");
+
 typedef struct
 {
-  char nome[100];
-  char tipo[100];
-  char comment[100];
+  char *nome;
+  char *tipo;
+  char *comment;
   int dimension;
-  char edgeWeightType[20];
+  char *edgeWeightType;
   Coordenada *nodes;
   float **distances;
   bool buildMatrix;
 } Instance;
 
+typedef struct
+{
+  float minX;
+  float minY;
+  float minZ;
+  float tamCelula;
+  int nx;
+  int ny;
+  int nz;
+  int *inicio;   // Posição em vertices do início de cada célula
+  int *vertices; // Vértices ordenados por célula
+} Grade;
 
-//Headers
-float fitness(Instance instance, int *rota);
-float distance(int, int, Instance);
-char* getTimeStamp();
+typedef struct
+{
+  int u;
+  int v;
+  float distancia;
+  float peso;
+} Aresta;
+
+
+typedef struct
+{
+  int dimensao;
+  int *rota;        // Rota corrente
+  int *melhorRota;
+  int *lrc;         // Lista restrita de candidatos do GRASP
+  bool *visitados;
+  int *adj1;        // Rascunho do GPX (2 vizinhos por vértice)
+  int *adj2;
+  int *conjunto;
+  int *corte;
+  int *pos;         // Posição de cada vértice na rota (2opt local)
+  int *fila;        // Fila de vértices ativos do 2opt local
+  float *custo1;
+  float *custo2;
+  bool *difere;
+  bool *usaPai2;
+  void *memoria;    // Bloco único que contém todos os vetores
+  size_t tamanho;
+} AreaTrabalho;
+
+typedef struct
+{
+  int inicio;       // Posição inicial do trecho (cíclico) alterado na rota
+  int tamanho;
+} Trecho;
+
+typedef struct
+{
+  void (*funcao)(void *);
+  void *argumento;
+} Tarefa;
+
+typedef struct
+{
+  Tarefa *tarefas;
+  int inicio; // Próxima tarefa do dono da fila
+  int fim;    // Após a última tarefa (de onde os outros roubam)
+  pthread_mutex_t trava;
+} FilaTrabalho;
+
+typedef struct
+{
+  FilaTrabalho *filas;
+  int qtdTrabalhadores;
+  int proximaFila;
+} PoolTrabalho;
+
+typedef struct
+{
+  Instance *instance;
+  char *arquivo;
+  int execucao;
+  unsigned int semente;
+  double orcamento;
+  int *melhorRota;
+  float distancia;
+  int iteracoes;
+  double tempo;
+  int trabalhador;
+  AreaTrabalho **areas; // Uma área por trabalhador do pool
+} TarefaLote;
+
+typedef struct
+{
+  char *arquivo;
+  Instance instance;
+  TspSolver *solver;
+  Grade grade;
+  int *candidatos;   // Grafo candidato (dimension x k)
+  int k;
+  float limite;      // Limite inferior (0 enquanto não calculado)
+  int *elite[GPX_ELITE];
+  float eliteDist[GPX_ELITE];
+  int qtdElite;
+  AreaTrabalho *area; // Área de trabalho usada pelo GPX
+  unsigned int requisicoes; // Requisições atendidas (define a semente padrão)
+} InstanciaResidente;
+
+typedef struct
+{
+  Instance instance;
+  int *rotaInicial;
+  int *melhorRota;
+  int *candidatos;   // Grafo candidato residente (dimension x k)
+  int k;
+  AreaTrabalho **areas; // Uma área por trabalhador do pool
+  float distancia;
+  double tempoLimite;
+  unsigned int semente;
+  int iteracoes;
+} TarefaMelhoria;
+
+
+typedef struct
+{
+  Instance instance;
+  int *rota;
+  int k;
+  int primeira; // Primeira janela da tarefa
+  int passo;    // Distância entre as janelas da tarefa
+  bool *limpa;
+  bool *melhorou;
+  float *custo; // Tabelas da programação dinâmica da tarefa
+  char *pai;
+} TarefaJanela;
 
 
+//Headers
+static float fitness(Instance instance, int *rota);
+static float distance(int, int, Instance);
+#ifndef TSP_BIBLIOTECA
+static void getTimeStamp(char *buffer);
+#endif // TSP_BIBLIOTECA
+static int aleatorio();
+static PoolTrabalho *criaPool(int qtdTrabalhadores, int capacidade);
+static void submetePool(PoolTrabalho *pool, void (*funcao)(void *), void *argumento);
+static bool executaPool(PoolTrabalho *pool);
+static void liberaPool(PoolTrabalho *pool);
+
+//Semente do gerador aleatório, uma por thread
+static __thread unsigned int semente = 1;
+//Índice do trabalhador do pool executando a thread atual
+static __thread int trabalhadorAtual = 0;
+
+
+#ifndef TSP_BIBLIOTECA
 //DataSets filenames
-char dataSets[8][20]={
+static char dataSets[8][20]={
   "star100.tsp",
   "star1k.tsp",
   "star10k.tsp",
@@ -55,35 +220,52 @@ char dataSets[8][20]={
   "star250k.tsp"
 };
 
-Instance readTspFile(char *fileName, bool buildMatrix)
+/**
+ * @brief Lê uma instância de um arquivo .tsp sem encerrar o programa em caso de erro
+ *
+ * @param fileName caminho do arquivo
+ * @param buildMatrix indica se a matriz de distâncias deve ser construída
+ * @param saida instância lida (preenchida apenas em caso de sucesso)
+ * @return bool false se o arquivo não puder ser aberto ou tiver dados inválidos
+ */
+static bool lerInstancia(char *fileName, bool buildMatrix, Instance *saida)
 {
-  char buffer[100];
+  char buffer[100] = "";
   char field[100];
+  char nome[100], tipo[100], comment[100], edgeWeightType[100];
   Instance instance;
   instance.buildMatrix = buildMatrix;
 
-  sprintf(buffer,"data/%s",fileName);
-
   printf("Abrindo arquivo %s\n", fileName);
   // Abre o arquivo .tsp
-  FILE *file = fopen(buffer, "r");
+  FILE *file = fopen(fileName, "r");
   if (file == NULL)
   {
     perror("Erro ao abrir aquivo de entrada:");
-    exit(0);
+    return false;
   } // if
 
   // Lê os atributos da instancia
-  fscanf(file, "%*[^:] : %[^\n]\n", instance.nome);
-  fscanf(file, "%*[^:] : %[^\n]\n", instance.tipo);
-  fscanf(file, "%*[^:] : %[^\n]\n", instance.comment);
+  fscanf(file, "%*[^:] : %[^\n]\n", nome);
+  fscanf(file, "%*[^:] : %[^\n]\n", tipo);
+  fscanf(file, "%*[^:] : %[^\n]\n", comment);
   do
   {
     fscanf(file, "%[^:]:%[^\n]\n", field, buffer);
   } while (strcmp(field, "COMMENT ") == 0);
   instance.dimension = strtol(buffer, NULL, 10);
-  fscanf(file, "%*[^:]:%[^\n]\n", instance.edgeWeightType);
+  if (instance.dimension < 3)
+  {
+    printf("Erro: dimensão inválida em %s\n", fileName);
+    fclose(file);
+    return false;
+  } // if
+  fscanf(file, "%*[^:]:%[^\n]\n", edgeWeightType);
   fscanf(file, "%*[^\n]\n");
+  instance.nome = strdup(nome);
+  instance.tipo = strdup(tipo);
+  instance.comment = strdup(comment);
+  instance.edgeWeightType = strdup(edgeWeightType);
 
   // Aloca dinamicamente o vetor para a dimensão da instância
   instance.nodes = (Coordenada *)malloc(sizeof(Coordenada) * instance.dimension);
@@ -92,7 +274,18 @@ Instance readTspFile(char *fileName, bool buildMatrix)
   printf("Lendo %d vertices...", instance.dimension);
   for (int i = 0; i < instance.dimension; i++)
   {
-    fscanf(file, "%*d %f %f %f\n", &instance.nodes[i].x, &instance.nodes[i].y, &instance.nodes[i].z);
+    if (fscanf(file, "%*d %f %f %f\n", &instance.nodes[i].x, &instance.nodes[i].y, &instance.nodes[i].z) != 3 ||
+        !isfinite(instance.nodes[i].x) || !isfinite(instance.nodes[i].y) || !isfinite(instance.nodes[i].z))
+    {
+      printf("\nErro: coordenada inválida no vértice %d\n", i + 1);
+      fclose(file);
+      free(instance.nodes);
+      free(instance.nome);
+      free(instance.tipo);
+      free(instance.comment);
+      free(instance.edgeWeightType);
+      return false;
+    } // if
   } // for
   printf("OK\n");
 
@@ -124,15 +317,30 @@ Instance readTspFile(char *fileName, bool buildMatrix)
     } // for
     printf("\rCalculando matriz de distancias... 100%% OK\n");
   }//if
+  fclose(file);
+
+  *saida = instance;
+  return true;
+
+} // lerInstancia
+
+static Instance readTspFile(char *fileName, bool buildMatrix)
+{
+  Instance instance;
 
+  if (!lerInstancia(fileName, buildMatrix, &instance))
+  {
+    exit(1);
+  } // if
   return instance;
 
 } // readTspFile
 
 
-void saveTour(Instance instance, int* rota){
-  char filename[120];
-  char* timestamp = getTimeStamp();
+static void saveTour(Instance instance, int* rota){
+  char filename[220];
+  char timestamp[100];
+  getTimeStamp(timestamp);
 
   sprintf(filename,"results/%s - %s.tour",instance.nome,timestamp);
   FILE* file = fopen(filename,"w");
@@ -152,19 +360,55 @@ void saveTour(Instance instance, int* rota){
   fprintf(file, "EOF\n");
 
   fclose(file);
-  free(timestamp);
 
 }//saveTour
 
+/**
+ * @brief Lê a rota de um arquivo .tour (TSPLIB)
+ *
+ * @param fileName caminho do arquivo
+ * @param dimensao quantidade de vértices esperada
+ * @param rota vetor onde será gravada a rota (vértices a partir de 0)
+ * @return int quantidade de vértices lidos (-1 se a rota for inválida)
+ */
+static int lerTour(char *fileName, int dimensao, int *rota){
+  char buffer[200];
+  bool *visitados;
+  int vertice, lidos = 0;
+
+  FILE *file = fopen(fileName, "r");
+  if (file == NULL)
+  {
+    perror("Erro ao abrir a rota:");
+    return -1;
+  } // if
+
+  // Ignora o cabeçalho
+  while (fgets(buffer, sizeof(buffer), file) != NULL && strncmp(buffer, "TOUR_SECTION", 12) != 0);
+
+  visitados = (bool *)calloc(dimensao, sizeof(bool));
+  while (fscanf(file, "%d", &vertice) == 1 && vertice != -1){
+    if (vertice < 1 || vertice > dimensao || visitados[vertice - 1] || lidos == dimensao){
+      lidos = -1;
+      break;
+    }//if
+    visitados[vertice - 1] = true;
+    rota[lidos++] = vertice - 1;
+  }//while
+
+  free(visitados);
+  fclose(file);
+  return lidos;
+}//lerTour
+
 /**
  * @brief Create a Log File object
  * 
  * @param instance 
  * @return FILE* 
  */
-FILE* createLogFile(Instance instance){
+static FILE* createLogFile(Instance instance){
   char filename[120];
-  char* timestamp = getTimeStamp();
 
   sprintf(filename,"logs/Log %s.csv",instance.nome);
   FILE* logFile = fopen(filename,"w");
@@ -174,6 +418,7 @@ FILE* createLogFile(Instance instance){
   return logFile;
 
 }
+#endif // TSP_BIBLIOTECA
 
 /**
  * @brief Calcula a distancia entre dois vértices tridimensionais
@@ -184,7 +429,7 @@ FILE* createLogFile(Instance instance){
  * @return float distancia entre os vértices
  */
 
-float distance(int o,int d, Instance instance){
+static float distance(int o,int d, Instance instance){
   if(BUILDMATRIX){
     return instance.distances[o][d];
   }else{
@@ -195,12 +440,32 @@ float distance(int o,int d, Instance instance){
   }//else
 }//distance
 
+#ifndef TSP_BIBLIOTECA
+/**
+ * @brief Libera a memória de uma instância lida por readTspFile
+ *
+ * @param instance instância a ser liberada
+ */
+static void liberaInstancia(Instance instance){
+  free(instance.nodes);
+  if (BUILDMATRIX){
+    for (int i = 0; i < instance.dimension; i++){
+      free(instance.distances[i]);
+    }//for
+    free(instance.distances);
+  }//if
+  free(instance.nome);
+  free(instance.tipo);
+  free(instance.comment);
+  free(instance.edgeWeightType);
+}//liberaInstancia
+
 /**
  * @brief Exibe na tela os dados de uma instancia
  * 
  * @param instance instância a ser exibida
  */
-void displayInstance(Instance instance)
+static void displayInstance(Instance instance)
 {
 
   printf("Nome: %s\n", instance.nome);
@@ -226,6 +491,7 @@ void displayInstance(Instance instance)
   return;
 
 } // displayInstance method
+#endif // TSP_BIBLIOTECA
 
 /**
  * @brief Calcula o custo da rota para a instancia especificada
@@ -234,7 +500,7 @@ void displayInstance(Instance instance)
  * @param rota rota a ser avaliada
  * @return float custo da rota
  */
-float fitness(Instance instance, int *rota)
+static float fitness(Instance instance, int *rota)
 {
   int i;
   float soma = 0;
@@ -248,18 +514,103 @@ float fitness(Instance instance, int *rota)
 } // fitness method
 
 /**
- * @brief Gera uma rota aleatória para uma instancia de tamanho tamanho
+ * @brief Arredonda um tamanho para o próximo múltiplo de ALINHAMENTO bytes
+ */
+static size_t alinhaTamanho(size_t tamanho){
+  return (tamanho + ALINHAMENTO - 1) & ~(size_t)(ALINHAMENTO - 1);
+}//alinhaTamanho
+
+/**
+ * @brief Cria a área de trabalho de um trabalhador para instâncias de até dimensao vértices
+ *
+ * Todos os vetores usados no laço de busca ficam em um único bloco alocado
+ * uma vez, alinhado e já mapeado. Com HUGEPAGES (desligado por padrão) o
+ * bloco usa páginas grandes quando o sistema as tiver reservadas, ou pede
+ * páginas grandes transparentes ao kernel.
+ *
+ * @param dimensao quantidade de vértices da instância
+ * @return AreaTrabalho* área criada (NULL se faltar memória)
+ */
+static AreaTrabalho *criaAreaTrabalho(int dimensao){
+  AreaTrabalho *area = (AreaTrabalho *)malloc(sizeof(AreaTrabalho));
+  size_t n = dimensao;
+  size_t vetorInt = alinhaTamanho(n * sizeof(int));
+  size_t vetorFloat = alinhaTamanho(n * sizeof(float));
+  size_t vetorBool = alinhaTamanho(n * sizeof(bool));
+  size_t tamanhoGrande;
+  char *bloco;
+
+  if (area == NULL){
+    return NULL;
+  }//if
+
+  // rota, melhorRota, lrc, adj1 (2n), adj2 (2n), conjunto, corte, pos e fila
+  area->tamanho = 11 * vetorInt + 2 * vetorFloat + 3 * vetorBool;
+  area->memoria = MAP_FAILED;
+  if (HUGEPAGES){
+    // MAP_HUGETLB exige um múltiplo do tamanho da página grande
+    tamanhoGrande = (area->tamanho + PAGINA_GRANDE - 1) & ~(size_t)(PAGINA_GRANDE - 1);
+    area->memoria = mmap(NULL, tamanhoGrande, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+    if (area->memoria != MAP_FAILED){
+      area->tamanho = tamanhoGrande;
+    }//if
+  }//if
+  if (area->memoria == MAP_FAILED){
+    area->memoria = mmap(NULL, area->tamanho, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (area->memoria == MAP_FAILED){
+      free(area);
+      return NULL;
+    }//if
+    if (HUGEPAGES){
+      madvise(area->memoria, area->tamanho, MADV_HUGEPAGE);
+    }//if
+    memset(area->memoria, 0, area->tamanho); // Evita faltas de página no laço de busca
+  }//if
+
+  bloco = (char *)area->memoria;
+  area->dimensao = dimensao;
+  area->rota = (int *)bloco;       bloco += vetorInt;
+  area->melhorRota = (int *)bloco; bloco += vetorInt;
+  area->lrc = (int *)bloco;        bloco += vetorInt;
+  area->adj1 = (int *)bloco;       bloco += 2 * vetorInt;
+  area->adj2 = (int *)bloco;       bloco += 2 * vetorInt;
+  area->conjunto = (int *)bloco;   bloco += vetorInt;
+  area->corte = (int *)bloco;      bloco += vetorInt;
+  area->pos = (int *)bloco;        bloco += vetorInt;
+  area->fila = (int *)bloco;       bloco += vetorInt;
+  area->custo1 = (float *)bloco;   bloco += vetorFloat;
+  area->custo2 = (float *)bloco;   bloco += vetorFloat;
+  area->visitados = (bool *)bloco; bloco += vetorBool;
+  area->difere = (bool *)bloco;    bloco += vetorBool;
+  area->usaPai2 = (bool *)bloco;
+
+  return area;
+}//criaAreaTrabalho
+
+/**
+ * @brief Libera uma área de trabalho
+ *
+ * @param area área a ser liberada
+ */
+static void liberaAreaTrabalho(AreaTrabalho *area){
+  if (area != NULL){
+    munmap(area->memoria, area->tamanho);
+    free(area);
+  }//if
+}//liberaAreaTrabalho
+
+/**
+ * @brief Gera uma rota aleatória em um vetor já alocado
  * 
  * @param tamanho tamanho da rota a ser gerada
- * @return int* vetor de inteiros contendo a rota
+ * @param rota vetor onde será gravada a rota
  */
-int *geraRotaAleatoria(int tamanho)
+static void geraRotaAleatoriaEm(int tamanho, int *rota)
 {
   int trocaPos;
   int troca;
 
-  int *rota = (int *)malloc(tamanho * sizeof(int));
-
   // Inicia a rota em ordem
   for (int i = 0; i < tamanho; i++)
   {
@@ -269,28 +620,42 @@ int *geraRotaAleatoria(int tamanho)
   // Embaralha a rota aleatóriamente
   for (int i = 1; i < tamanho; i++)
   {
-    trocaPos = (rand() % 98) + 1;
+    trocaPos = (aleatorio() % (tamanho - 1)) + 1;
     troca = rota[i];
     rota[i] = rota[trocaPos];
     rota[trocaPos] = troca;
   } // for
+} // geraRotaAleatoriaEm
+
+/**
+ * @brief Gera uma rota aleatória para uma instancia de tamanho tamanho
+ * 
+ * @param tamanho tamanho da rota a ser gerada
+ * @return int* vetor de inteiros contendo a rota
+ */
+static int *geraRotaAleatoria(int tamanho)
+{
+  int *rota = (int *)malloc(tamanho * sizeof(int));
+  if (rota != NULL)
+  {
+    geraRotaAleatoriaEm(tamanho, rota);
+  } // if
   return rota;
 } // geraRotaAleatoria método
 
 /**
- * @brief Cria uma rota utilizando a estrátégia gulosa (vizinho mais próximo)
+ * @brief Cria uma rota gulosa (vizinho mais próximo) em vetores já alocados
  * 
  * @param instance instancia a ser utilizada
- * @return int* vetor de inteiros contendo a rota gulosa
+ * @param rota vetor onde será gravada a rota
+ * @param visitados vetor de trabalho (dimension posições)
  */
-int *geraRotaGulosa(Instance instance)
+static void geraRotaGulosaEm(Instance instance, int *rota, bool *visitados)
 {
-  //printf("Gerando rota inicial gulosa....");
-  int *rota = (int *)malloc(instance.dimension * sizeof(int));
-  bool *visitados = (bool *)malloc(instance.dimension * sizeof(bool));
   float distProx;
   float distCur;
   int proximo = 0;
+  int atual;
   int i, j;
 
   // Marca vertices como não visitados
@@ -301,14 +666,15 @@ int *geraRotaGulosa(Instance instance)
   } // for
 
   // Para cada vertice
-  for (i = 0; i < instance.dimension; i++)
+  for (i = 0; i < instance.dimension - 1; i++)
   {
     // Localiza o vértice mais próximo
     distProx = INFINITY;
+    atual = proximo;
     for (j = 1; j < instance.dimension; j++)
     {
       
-      distCur = distance(proximo, j, instance);
+      distCur = distance(atual, j, instance);
       if (distCur < distProx && !visitados[j])
       {
         distProx = distCur;
@@ -321,26 +687,50 @@ int *geraRotaGulosa(Instance instance)
     visitados[proximo] = true;
 
   } // for
+  rota[instance.dimension - 1] = 0; // A rota termina no vértice inicial
+} // geraRotaGulosaEm
+
+/**
+ * @brief Cria uma rota utilizando a estrátégia gulosa (vizinho mais próximo)
+ * 
+ * @param instance instancia a ser utilizada
+ * @return int* vetor de inteiros contendo a rota gulosa
+ */
+static int *geraRotaGulosa(Instance instance)
+{
+  //printf("Gerando rota inicial gulosa....");
+  int *rota = (int *)malloc(instance.dimension * sizeof(int));
+  bool *visitados = (bool *)malloc(instance.dimension * sizeof(bool));
+
+  if (rota != NULL && visitados != NULL)
+  {
+    geraRotaGulosaEm(instance, rota, visitados);
+  }
+  else
+  {
+    free(rota);
+    rota = NULL;
+  } // else
+  free(visitados);
   //printf("OK\n");
 
   return rota;
 } // geraRotaGulosa
 
 /**
- * @brief Cria 
+ * @brief Cria uma rota GRASP em vetores já alocados
  * 
- * @param instance 
- * @param alpha 
- * @return int* vetor de inteiros contendo a rota
+ * @param instance instancia a ser utilizada
+ * @param alpha parâmetro de aleatoriedade da LRC (0 = guloso)
+ * @param rota vetor onde será gravada a rota
+ * @param visitados vetor de trabalho (dimension posições)
+ * @param lrc vetor de trabalho para a lista restrita de candidatos (dimension posições)
  */
-int *geraRotaGrasp(Instance instance, float alpha)
+static void geraRotaGraspEm(Instance instance, float alpha, int *rota, bool *visitados, int *lrc)
 {
-  int *rota = (int *)malloc(instance.dimension * sizeof(int));
-  bool *visitados = (bool *)malloc(instance.dimension * sizeof(bool));
-
   int i, j;
   float min, max, corte;
-  int cardinalidade, sorteio, contaCandidatos;
+  int cardinalidade;
   int proximo = 0;
   float distCur;
 
@@ -376,47 +766,65 @@ int *geraRotaGrasp(Instance instance, float alpha)
     //Calcula custo de corte
     corte = min + (alpha * (max - min));
 
-    // Calcula cardinalidade da LRC
+    // Monta a LRC
     cardinalidade = 0;
     for (j = 0; j < instance.dimension; j++)
     {
       if ( distance(proximo,j,instance) <= corte && !visitados[j])
       {
-        cardinalidade++;
+        lrc[cardinalidade++] = j;
       } // if
     }   // for
 
-    //Sorteia um candidato da LRC
-    sorteio = rand() % cardinalidade;
-
-    // Procura o candidato sorteado na RLC
-    contaCandidatos = 0;
-    for (j = 0; j < instance.dimension; j++)
+    // Distâncias inválidas (NaN) não passam no corte: segue com o primeiro não visitado
+    for (j = 0; cardinalidade == 0 && j < instance.dimension; j++)
     {
-      //Verifica se é um candidato da RLC
-      if ( distance(proximo,j,instance) <= corte && !visitados[j])
+      if (!visitados[j])
       {
-        //Verifica se é o candidato sorteado
-        if (contaCandidatos == sorteio)
-        {
-          proximo = j;
-          break;
-        }
-        contaCandidatos++;
-
+        lrc[cardinalidade++] = j;
       } // if
     }   // for
+
+    //Sorteia um candidato da LRC
+    proximo = lrc[aleatorio() % cardinalidade];
     
     // Adiciona na rota
     rota[i] = proximo;
     visitados[proximo] = true;
 
   } // for
+  rota[instance.dimension - 1] = 0; // A rota termina no vértice inicial
+} // geraRotaGraspEm
+
+/**
+ * @brief Cria uma rota utilizando a construção GRASP
+ * 
+ * @param instance instancia a ser utilizada
+ * @param alpha parâmetro de aleatoriedade da LRC (0 = guloso)
+ * @return int* vetor de inteiros contendo a rota
+ */
+static int *geraRotaGrasp(Instance instance, float alpha)
+{
+  int *rota = (int *)malloc(instance.dimension * sizeof(int));
+  bool *visitados = (bool *)malloc(instance.dimension * sizeof(bool));
+  int *lrc = (int *)malloc(instance.dimension * sizeof(int));
+
+  if (rota != NULL && visitados != NULL && lrc != NULL)
+  {
+    geraRotaGraspEm(instance, alpha, rota, visitados, lrc);
+  }
+  else
+  {
+    free(rota);
+    rota = NULL;
+  } // else
+  free(visitados);
+  free(lrc);
 
   return rota;
 } // geraRotaGrasp
 
-void run2optReverse(int *rota, int inicio, int fim)
+static void run2optReverse(int *rota, int inicio, int fim)
 {
   int troca;
   for (int i = inicio + 1, j = fim; i < j; i++, j--)
@@ -427,7 +835,7 @@ void run2optReverse(int *rota, int inicio, int fim)
   }
 }
 
-int runSa2opt(Instance instance, int *rota)
+static int runSa2opt(Instance instance, int *rota)
 {
   int node1;
   int node2;
@@ -450,7 +858,7 @@ int runSa2opt(Instance instance, int *rota)
           +distance(rota[node1], rota[(node2) % instance.dimension], instance)
           +distance(rota[(node1 + 1) % instance.dimension],rota[(node2 + 1) % instance.dimension], instance);
 
-        if (delta < -0.00001 || ((float)(rand() % 1000) < temperatura))
+        if (delta < -0.00001 || ((float)(aleatorio() % 1000) < temperatura))
         {
           run2optReverse(rota, node1, node2);
           distancia += delta;
@@ -470,7 +878,7 @@ int runSa2opt(Instance instance, int *rota)
  * @param rota rota inicial a ser melhorada
  * @return float custo da rota melhorada
  */
-float run2optFirst(Instance instance, int *rota)
+static float run2optFirst(Instance instance, int *rota)
 {
   int node1;
   int node2;
@@ -482,7 +890,8 @@ float run2optFirst(Instance instance, int *rota)
   //Utilizado para gerar o log para o gráfico do 2opt
   int interations = 0; 
   char filename[100];
-  char* timestamp = getTimeStamp();
+  char timestamp[100];
+  getTimeStamp(timestamp);
   sprintf(filename,"log2opt-%s.txt",timestamp);
   FILE* logFile = fopen(filename,"w");
   fprintf(logFile,"%f\n",distancia);
@@ -526,20 +935,21 @@ float run2optFirst(Instance instance, int *rota)
  * @param rota rota inicial a ser melhorada
  * @return float custo da rota melhorada
  */
-float run2optBest(Instance instance, int *rota)
+static float run2optBest(Instance instance, int *rota)
 {
   int node1;
   int node2;
   float distancia = fitness(instance, rota);
   float delta;
   bool melhorou = true;
-  float bestDelta = 1000;
+  float bestDelta;
   int bestNode1;
   int bestNode2;
 
   while (melhorou)
   {
     melhorou = false;
+    bestDelta = -0.001; // Mesma tolerância do 2opt First
     for (node1 = 0; node1 < instance.dimension-1; node1++)
     {
       for (node2 = node1 + 1; node2 < instance.dimension; node2++)
@@ -574,7 +984,7 @@ float run2optBest(Instance instance, int *rota)
  * @param rota rota inicial a ser melhorada
  * @return float custo da rota melhorada
  */
-float run2optShake(Instance instance, int* rota, int intensity, int shake){
+static float run2optShake(Instance instance, int* rota, int intensity, int shake){
   float distancia;
   float minDistancia;
   float distanciaInicial;
@@ -585,13 +995,14 @@ float run2optShake(Instance instance, int* rota, int intensity, int shake){
   distancia = run2optFirst(instance, rota);
   distanciaInicial = distancia;
   minDistancia = distancia;
+  memcpy(melhorRota,rota,instance.dimension * sizeof(int));
 
   for (int i = 0; i < shake; i++){
 
     for (int j = 0; j < intensity; j++){
     
-      node1 = (rand()% instance.dimension-1)+1;
-      node2 = (rand()% instance.dimension-1)+1;
+      node1 = (aleatorio()% instance.dimension-1)+1;
+      node2 = (aleatorio()% instance.dimension-1)+1;
 
       troca = rota[node1];
       rota[node1] = rota[node2];
@@ -610,7 +1021,7 @@ float run2optShake(Instance instance, int* rota, int intensity, int shake){
   }//for shake interations
 
   memcpy(rota,melhorRota,instance.dimension * sizeof(int));
-  //free(melhorRota);
+  free(melhorRota);
   if(minDistancia < distanciaInicial ){
     printf("Shake melhorou: de %f para %f\n",distanciaInicial, minDistancia);
   }
@@ -618,7 +1029,7 @@ float run2optShake(Instance instance, int* rota, int intensity, int shake){
 }//run2optShake
 
 
-float run2vert(Instance instance, int *rota)
+static float run2vert(Instance instance, int *rota)
 {
   int node1;
   int node2;
@@ -663,129 +1074,2534 @@ float run2vert(Instance instance, int *rota)
   return distancia;
 } // run2vert
 
-//Funções auxiliares para exibir o tempo durante a execução
+/**
+ * @brief Inverte o trecho cíclico da rota entre as posições i e j (inclusive)
+ *
+ * Se o trecho for maior que meia rota, inverte o complemento, que resulta no
+ * mesmo ciclo. Atualiza o vetor de posições.
+ *
+ * @param rota rota a ser alterada
+ * @param pos posição de cada vértice na rota
+ * @param n tamanho da rota
+ * @param i posição inicial do trecho
+ * @param j posição final do trecho
+ * @param trecho registra as posições efetivamente alteradas (ou NULL)
+ */
+static void reverteCiclico(int *rota, int *pos, int n, int i, int j, Trecho *trecho){
+  int tamanho = (j - i + n) % n + 1;
+  int troca;
 
+  if (2 * tamanho > n){
+    troca = i;
+    i = (j + 1) % n;
+    j = (troca - 1 + n) % n;
+    tamanho = n - tamanho;
+  }//if
+  if (trecho != NULL){
+    trecho->inicio = i;
+    trecho->tamanho = tamanho;
+  }//if
+
+  for (int t = 0; t < tamanho / 2; t++){
+    troca = rota[i];
+    rota[i] = rota[j];
+    rota[j] = troca;
+    pos[rota[i]] = i;
+    pos[rota[j]] = j;
+    i = (i + 1) % n;
+    j = (j - 1 + n) % n;
+  }//for
+}//reverteCiclico
 
 /**
- * @brief Calcula a diferença de tempo em segundos um timestamp e o tempo atual
- * 
- * @param initialTick tempo inicial
- * @return double diferença entre os tempos em segundos
+ * @brief Inverte o trecho rota[i..j] (inclusive)
  */
-double calculaTempo(clock_t initialTick){
-  return (double)(clock() - initialTick) / (CLOCKS_PER_SEC);
-}
+static void inverteTrecho(int *rota, int i, int j){
+  int troca;
+
+  for (; i < j; i++, j--){
+    troca = rota[i];
+    rota[i] = rota[j];
+    rota[j] = troca;
+  }//for
+}//inverteTrecho
 
 /**
- * @brief Calcula a diferença de tempo em segundos entre 2 timestamps
- * 
- * @param initialTick tempo inicial
- * @param finalTick tempo final
- * @return double diferença entre os tempos em segundos
+ * @brief Rotaciona a rota para que o vértice 0 fique na última posição (formato do saveTour)
+ *
+ * A rotação é feita no próprio vetor, com três inversões.
+ *
+ * @param rota rota a ser rotacionada
+ * @param n tamanho da rota
  */
-double calculaDiferencaTempo(clock_t initialTick, clock_t finalTick){
-  return (double)(finalTick - initialTick) / (CLOCKS_PER_SEC);
-}
+static void normalizaRota(int *rota, int n){
+  int zero = 0;
+
+  while (rota[zero] != 0){
+    zero++;
+  }//while
+  inverteTrecho(rota, 0, zero);
+  inverteTrecho(rota, zero + 1, n - 1);
+  inverteTrecho(rota, 0, n - 1);
+}//normalizaRota
 
 /**
- * @brief Gera e retora uma string contendo o timestamp
- * 
- * @return char* string contendo o timestamp com data e hora
+ * @brief Executa o 2opt restrito ao grafo candidato, a partir de uma fila de vértices ativos
+ *
+ * Cada vértice ativo tenta ligar-se a um dos seus vizinhos candidatos mais
+ * próximos que a aresta atual; quando um movimento é aplicado, os quatro
+ * vértices envolvidos voltam a ficar ativos. Vértices que não estão ativos
+ * não são examinados, então apenas as regiões alteradas são otimizadas.
+ * Ao final a fila está vazia e ativo está todo falso, prontos para a próxima busca.
+ *
+ * @param instance instancia a ser considerada
+ * @param rota rota a ser melhorada (em qualquer rotação)
+ * @param pos posição de cada vértice na rota (mantida atualizada)
+ * @param candidatos grafo candidato (dimension x k)
+ * @param k quantidade de vizinhos por vértice
+ * @param ativo marca dos vértices que estão na fila
+ * @param fila vetor com n posições; as qtdFila primeiras são os vértices ativos
+ * @param qtdFila quantidade de vértices na fila
+ * @param trechos registro dos trechos invertidos (ou NULL)
+ * @param qtdTrechos quantidade de inversões; acima de TRECHOS_MAX o registro está incompleto
+ * @return double variação do custo da rota
  */
-char* getTimeStamp(){
-  char* buffer = (char*) malloc(100* sizeof(char));
-  time_t rawtime;
-  struct tm * timeinfo;
+static double buscaVizinhanca(Instance instance, int *rota, int *pos, int *candidatos, int k, bool *ativo,
+                              int *fila, int qtdFila, Trecho *trechos, int *qtdTrechos){
+  int n = instance.dimension;
+  int inicioFila = 0;
+  int a, b, c, d, sentido;
+  float dab, dac, delta;
+  double variacao = 0;
+  bool melhorou;
+  Trecho *trecho;
+
+  while (qtdFila > 0){
+    a = fila[inicioFila];
+    inicioFila = (inicioFila + 1) % n;
+    qtdFila--;
+    ativo[a] = false;
+
+    melhorou = false;
+    for (sentido = 1; sentido >= -1 && !melhorou; sentido -= 2){
+      // b é o sucessor (ou antecessor) de a; d é o de c no mesmo sentido
+      b = rota[(pos[a] + sentido + n) % n];
+      dab = distance(a, b, instance);
+      for (int j = 0; j < k; j++){
+        c = candidatos[(size_t)a * k + j];
+        dac = distance(a, c, instance);
+        if (dac >= dab){
+          break; // Candidatos estão em ordem crescente de distância
+        }//if
+        d = rota[(pos[c] + sentido + n) % n];
+        if (c == b || d == a){
+          continue;
+        }//if
+
+        delta = dac + distance(b, d, instance) - dab - distance(c, d, instance);
+        if (delta < -0.001){
+          // Troca (a,b),(c,d) por (a,c),(b,d)
+          trecho = NULL;
+          if (trechos != NULL && (*qtdTrechos)++ < TRECHOS_MAX){
+            trecho = &trechos[*qtdTrechos - 1];
+          }//if
+          if (sentido == 1){
+            reverteCiclico(rota, pos, n, pos[b], pos[c], trecho);
+          }else{
+            reverteCiclico(rota, pos, n, pos[a], pos[d], trecho);
+          }//else
+          variacao += delta;
+          int envolvidos[4] = {a, b, c, d};
+          for (int t = 0; t < 4; t++){
+            if (!ativo[envolvidos[t]]){
+              ativo[envolvidos[t]] = true;
+              fila[(inicioFila + qtdFila++) % n] = envolvidos[t];
+            }//if
+          }//for
+          melhorou = true;
+          break;
+        }//if
+      }//for
+    }//for
+  }//while
 
+  return variacao;
+}//buscaVizinhanca
 
-  time ( &rawtime );
-  timeinfo = localtime ( &rawtime );
+/**
+ * @brief Executa o 2opt restrito ao grafo candidato, a partir dos vértices ativos
+ *
+ * @param instance instancia a ser considerada
+ * @param rota rota a ser melhorada (vértice 0 na última posição ao final)
+ * @param candidatos grafo candidato (dimension x k)
+ * @param k quantidade de vizinhos por vértice
+ * @param ativo vértices a serem examinados (é consumido pela busca)
+ * @param pos vetor de trabalho com n posições (posição de cada vértice)
+ * @param fila vetor de trabalho com n posições (fila de vértices ativos)
+ * @return float custo da rota melhorada
+ */
+static float run2optVizinhanca(Instance instance, int *rota, int *candidatos, int k, bool *ativo, int *pos, int *fila){
+  int n = instance.dimension;
+  int qtdFila = 0;
 
-  sprintf(buffer, "%02d %02d %04d %02d:%02d:%02d", timeinfo->tm_mday,
-            timeinfo->tm_mon + 1, timeinfo->tm_year + 1900,
-            timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
-  return buffer;
+  for (int i = 0; i < n; i++){
+    pos[rota[i]] = i;
+  }//for
+  for (int v = 0; v < n; v++){
+    if (ativo[v]){
+      fila[qtdFila++] = v;
+    }//if
+  }//for
 
-}//timeStamp
+  buscaVizinhanca(instance, rota, pos, candidatos, k, ativo, fila, qtdFila, NULL, NULL);
+  normalizaRota(rota, n);
+  return fitness(instance, rota);
+}//run2optVizinhanca
 
 /**
- * @brief Função criada para avaliar o alpha do GRASP
- * 
- * @param instance instancia a ser avaliada
- * @param runs quantidade de execuções para cada valor de alpha
+ * @brief Resolve de forma exata o trecho interno de uma janela da rota (Held-Karp)
+ *
+ * As extremidades rota[inicio] e rota[inicio+k-1] permanecem fixas e os k-2
+ * vértices internos são reordenados no caminho de menor custo.
+ *
+ * @param instance instancia a ser considerada
+ * @param rota rota a ser alterada
+ * @param inicio posição inicial da janela
+ * @param k tamanho da janela (até JANELA_MAX)
+ * @param custo tabela de trabalho da DP ((1 << (k-2)) x (k-2) posições)
+ * @param pai tabela de trabalho com o antecessor de cada estado
+ * @return true se o trecho foi melhorado
  */
-void evaluateAlpha(Instance instance, int runs){
-  FILE* logFile;
+static bool otimizaJanela(Instance instance, int *rota, int inicio, int k, float *custo, char *pai){
+  int m = k - 2;
+  int estados = 1 << m;
+  int *interno = &rota[inicio + 1];
+  int a = rota[inicio];
+  int b = rota[inicio + k - 1];
+  int vertices[JANELA_MAX];
+  float dist[JANELA_MAX][JANELA_MAX];
+  float atual, melhor, valor;
+  int mascara, j, l, fim;
+
+  // Distâncias entre os vértices internos e custo do trecho atual
+  atual = distance(a, interno[0], instance) + distance(interno[m - 1], b, instance);
+  for (j = 0; j < m; j++){
+    vertices[j] = interno[j];
+    for (l = 0; l < m; l++){
+      dist[j][l] = distance(interno[j], interno[l], instance);
+    }//for
+    if (j > 0){
+      atual += dist[j - 1][j];
+    }//if
+  }//for
 
-  float alpha;
-  int* melhorRota = (int*) malloc(instance.dimension * sizeof(int));
+  // custo[mascara][j]: menor caminho saindo de a, visitando mascara e terminando em j
+  for (mascara = 1; mascara < estados; mascara++){
+    for (j = 0; j < m; j++){
+      if (!(mascara & (1 << j))) continue;
+      if (mascara == (1 << j)){
+        custo[mascara * m + j] = distance(a, vertices[j], instance);
+        pai[mascara * m + j] = -1;
+        continue;
+      }//if
+      melhor = INFINITY;
+      for (l = 0; l < m; l++){
+        if (l == j || !(mascara & (1 << l))) continue;
+        valor = custo[(mascara ^ (1 << j)) * m + l] + dist[l][j];
+        if (valor < melhor){
+          melhor = valor;
+          pai[mascara * m + j] = l;
+        }//if
+      }//for
+      custo[mascara * m + j] = melhor;
+    }//for
+  }//for
 
-  int *rota = NULL;
-  float distancia;
-  float distanciaGrasp;
-  float minDistancia = INFINITY;
- 
-    logFile = createLogFile( instance );
-    //Escreve o cabeçalho no arquivo de log
-    for ( alpha = 0; alpha <= 1; alpha = alpha + 0.025)
-    {
-      if(alpha==0){
-        fprintf(logFile,"%f",alpha);
-      }else{
-        fprintf(logFile,",%f",alpha);
-      }//else
-    }
-    fprintf(logFile,"\n");
-    minDistancia = INFINITY;
-    printf("Alpha %f\n",alpha);
+  // Fecha o caminho em b
+  melhor = INFINITY;
+  fim = 0;
+  for (j = 0; j < m; j++){
+    valor = custo[(estados - 1) * m + j] + distance(vertices[j], b, instance);
+    if (valor < melhor){
+      melhor = valor;
+      fim = j;
+    }//if
+  }//for
 
-  //Executa o algoritmo "runs" vezes
-  for (int i = 1; i <= runs; i++)
-  {
+  if (melhor >= atual - 0.001){
+    return false;
+  }//if
+
+  // Reconstrói o caminho ótimo de trás para frente
+  mascara = estados - 1;
+  for (int p = m - 1; p >= 0; p--){
+    interno[p] = vertices[fim];
+    l = pai[mascara * m + fim];
+    mascara ^= 1 << fim;
+    fim = l;
+  }//for
+
+  return true;
+}//otimizaJanela
+
+/**
+ * @brief Tarefa do pool: otimiza um subconjunto das janelas de uma fase
+ *
+ * @param arg TarefaJanela a ser executada
+ */
+static void executaTarefaJanela(void *arg){
+  TarefaJanela *tarefa = (TarefaJanela *)arg;
+
+  for (int s = tarefa->primeira; s + tarefa->k <= tarefa->instance.dimension; s += tarefa->passo){
+    if (!tarefa->limpa[s]){
+      tarefa->melhorou[s] = otimizaJanela(tarefa->instance, tarefa->rota, s, tarefa->k, tarefa->custo, tarefa->pai);
+      tarefa->limpa[s] = true;
+    }//if
+  }//for
+}//executaTarefaJanela
+
+/**
+ * @brief Pós-otimização exata por janelas deslizantes de k posições consecutivas
+ *
+ * Cada janela tem as extremidades fixas e o trecho interno resolvido por
+ * programação dinâmica. Janelas cujo conteúdo não mudou desde a última
+ * otimização são ignoradas. Janelas que começam a k-1 posições umas das
+ * outras só compartilham extremidades, então cada fase processa em paralelo
+ * as janelas com o mesmo deslocamento.
+ *
+ * @param instance instancia a ser considerada
+ * @param rota rota a ser melhorada
+ * @param k tamanho da janela (3 a JANELA_MAX)
+ * @param threads quantidade de threads
+ * @return float custo da rota melhorada (negativo se faltar memória; a rota continua válida)
+ */
+static float runJanelaDP(Instance instance, int *rota, int k, int threads){
+  int n = instance.dimension;
+  bool *limpa, *melhorou;
+  bool alterou = true, falhou = false;
+  TarefaJanela *tarefas;
+  PoolTrabalho *pool;
+  float distancia = -1;
+
+  if (k > JANELA_MAX) k = JANELA_MAX;
+  if (k > n) k = n;
+  if (k < 3){
+    return fitness(instance, rota);
+  }//if
+
+  limpa = (bool *)calloc(n, sizeof(bool));
+  melhorou = (bool *)calloc(n, sizeof(bool));
+  tarefas = (TarefaJanela *)calloc(threads, sizeof(TarefaJanela));
+  falhou = limpa == NULL || melhorou == NULL || tarefas == NULL;
+  for (int t = 0; t < threads && !falhou; t++){
+    tarefas[t].custo = (float *)malloc((1 << (k - 2)) * (k - 2) * sizeof(float));
+    tarefas[t].pai = (char *)malloc((1 << (k - 2)) * (k - 2) * sizeof(char));
+    falhou = tarefas[t].custo == NULL || tarefas[t].pai == NULL;
+  }//for
+
+  while (alterou && !falhou){
+    alterou = false;
+    for (int fase = 0; fase < k - 1 && !falhou; fase++){
+      // Cada thread fica com uma janela a cada "threads" janelas da fase
+      pool = criaPool(threads, 1);
+      if (pool == NULL){
+        falhou = true;
+        break;
+      }//if
+      for (int t = 0; t < threads; t++){
+        tarefas[t].instance = instance;
+        tarefas[t].rota = rota;
+        tarefas[t].k = k;
+        tarefas[t].primeira = fase + t * (k - 1);
+        tarefas[t].passo = threads * (k - 1);
+        tarefas[t].limpa = limpa;
+        tarefas[t].melhorou = melhorou;
+        submetePool(pool, executaTarefaJanela, &tarefas[t]);
+      }//for
+      falhou = !executaPool(pool);
+      liberaPool(pool);
+
+      // Janelas que compartilham posições internas alteradas voltam a ser examinadas
+      for (int s = fase; s + k <= n; s += k - 1){
+        if (!melhorou[s]) continue;
+        melhorou[s] = false;
+        alterou = true;
+        for (int t = s - k + 2; t <= s + k - 2; t++){
+          if (t >= 0 && t != s && t + k <= n){
+            limpa[t] = false;
+          }//if
+        }//for
+      }//for
+    }//for
+  }//while
+
+  if (!falhou){
+    distancia = fitness(instance, rota);
+  }//if
+  for (int t = 0; t < threads && tarefas != NULL; t++){
+    free(tarefas[t].custo);
+    free(tarefas[t].pai);
+  }//for
+  free(limpa);
+  free(melhorou);
+  free(tarefas);
+  return distancia;
+}//runJanelaDP
+
+/**
+ * @brief Localiza a raiz de um vértice no union-find (com compressão de caminho)
+ *
+ * @param conjunto vetor de pais do union-find
+ * @param v vértice consultado
+ * @return int raiz do conjunto do vértice
+ */
+static int gpxRaiz(int *conjunto, int v){
+  while (conjunto[v] != v){
+    conjunto[v] = conjunto[conjunto[v]];
+    v = conjunto[v];
+  }//while
+  return v;
+}//gpxRaiz
+
+/**
+ * @brief Verifica se a aresta (u,v) existe na rota representada pela lista de adjacência
+ *
+ * @param adj lista de adjacência (2 vizinhos por vértice)
+ * @param u vértice de origem
+ * @param v vértice de destino
+ * @return true se a aresta pertence à rota
+ */
+static bool gpxTemAresta(int *adj, int u, int v){
+  return adj[2 * u] == v || adj[2 * u + 1] == v;
+}//gpxTemAresta
+
+/**
+ * @brief Recombina duas rotas utilizando o Partition Crossover (GPX)
+ *
+ * As arestas comuns aos dois pais são mantidas. As arestas restantes formam
+ * componentes onde os pais diferem; cada componente que é ligado ao restante
+ * da rota por exatamente duas arestas comuns pode ser herdado de qualquer um
+ * dos pais, então o filho recebe o sub-caminho mais curto de cada um. Os
+ * demais componentes são herdados em bloco do pai que for melhor neles.
+ * Executa em tempo linear no tamanho da instância.
+ *
+ * @param instance instancia a ser considerada
+ * @param pai1 primeira rota pai
+ * @param pai2 segunda rota pai
+ * @param filho vetor onde será gravada a rota filha (vértice 0 na última posição)
+ * @param area área de trabalho com os vetores auxiliares
+ * @return float custo da rota filha
+ */
+static float gpx(Instance instance, int *pai1, int *pai2, int *filho, AreaTrabalho *area){
+  int n = instance.dimension;
+  int *adj1 = area->adj1;
+  int *adj2 = area->adj2;
+  int *conjunto = area->conjunto;
+  int *corte = area->corte;
+  float *custo1 = area->custo1;
+  float *custo2 = area->custo2;
+  bool *difere = area->difere;
+  bool *usaPai2 = area->usaPai2;
+  int *adjEscolhida;
+  float base1 = 0, base2 = 0;
+  int i, u, v, r, anterior, atual, proximo;
+
+  // Monta a lista de adjacência de cada pai
+  for (i = 0; i < n; i++){
+    corte[i] = 0;
+    custo1[i] = custo2[i] = 0;
+    difere[i] = false;
+    adj1[2 * pai1[i]] = pai1[(i + n - 1) % n];
+    adj1[2 * pai1[i] + 1] = pai1[(i + 1) % n];
+    adj2[2 * pai2[i]] = pai2[(i + n - 1) % n];
+    adj2[2 * pai2[i] + 1] = pai2[(i + 1) % n];
+    conjunto[i] = i;
+  }//for
+
+  // Agrupa em componentes os vértices ligados por arestas não comuns
+  for (u = 0; u < n; u++){
+    for (i = 0; i < 2; i++){
+      v = adj1[2 * u + i];
+      if (!gpxTemAresta(adj2, u, v)){
+        difere[u] = true;
+        conjunto[gpxRaiz(conjunto, u)] = gpxRaiz(conjunto, v);
+      }//if
+      v = adj2[2 * u + i];
+      if (!gpxTemAresta(adj1, u, v)){
+        conjunto[gpxRaiz(conjunto, u)] = gpxRaiz(conjunto, v);
+      }//if
+    }//for
+  }//for
+
+  // Calcula o custo de cada pai dentro do componente e as arestas de corte
+  for (u = 0; u < n; u++){
+    if (!difere[u]){
+      continue;
+    }//if
+    r = gpxRaiz(conjunto, u);
+    v = adj1[2 * u + 1];
+    if (!gpxTemAresta(adj2, u, v)){
+      custo1[r] += distance(u, v, instance);
+    }//if
+    v = adj2[2 * u + 1];
+    if (!gpxTemAresta(adj1, u, v)){
+      custo2[r] += distance(u, v, instance);
+    }//if
+    for (i = 0; i < 2; i++){
+      v = adj1[2 * u + i];
+      if (gpxTemAresta(adj2, u, v) && (!difere[v] || gpxRaiz(conjunto, v) != r)){
+        corte[r]++;
+      }//if
+    }//for
+  }//for
+
+  // Componentes não particionáveis são herdados juntos do pai melhor neles
+  for (u = 0; u < n; u++){
+    if (difere[u] && conjunto[u] == u && corte[u] != 2){
+      base1 += custo1[u];
+      base2 += custo2[u];
+    }//if
+  }//for
+
+  // Escolhe o pai de cada vértice (arestas comuns são iguais nos dois)
+  for (u = 0; u < n; u++){
+    usaPai2[u] = false;
+    if (difere[u]){
+      r = gpxRaiz(conjunto, u);
+      usaPai2[u] = (corte[r] == 2 && custo2[r] < custo1[r]) || (corte[r] != 2 && base2 < base1);
+    }//if
+  }//for
+
+  // Monta o filho seguindo, para cada vértice, a adjacência do pai escolhido
+  anterior = 0;
+  atual = usaPai2[0] ? adj2[1] : adj1[1];
+  for (i = 0; i < n - 1 && atual != 0; i++){
+    adjEscolhida = usaPai2[atual] ? adj2 : adj1;
+    filho[i] = atual;
+    proximo = adjEscolhida[2 * atual] == anterior ? adjEscolhida[2 * atual + 1] : adjEscolhida[2 * atual];
+    anterior = atual;
+    atual = proximo;
+  }//for
+  filho[n - 1] = 0;
+
+  // Segurança: se o filho não for um ciclo hamiltoniano, mantém o melhor pai
+  if (i != n - 1 || atual != 0){
+    memcpy(filho, fitness(instance, pai1) <= fitness(instance, pai2) ? pai1 : pai2, n * sizeof(int));
+  }//if
+
+  return fitness(instance, filho);
+}//gpx
+
+/**
+ * @brief Insere uma rota no conjunto elite, substituindo a pior se estiver cheio
+ *
+ * @param instance instancia a ser considerada
+ * @param elite conjunto de rotas elite (GPX_ELITE rotas já alocadas)
+ * @param eliteDist custo de cada rota elite
+ * @param qtdElite quantidade de rotas atualmente no conjunto
+ * @param rota rota a ser inserida
+ * @param distancia custo da rota a ser inserida
+ */
+static void insereElite(Instance instance, int **elite, float *eliteDist, int *qtdElite, int *rota, float distancia){
+  int pior = 0;
+
+  // Ignora rotas repetidas (mesmo custo)
+  for (int i = 0; i < *qtdElite; i++){
+    if (fabs(eliteDist[i] - distancia) < 0.001){
+      return;
+    }//if
+    if (eliteDist[i] > eliteDist[pior]){
+      pior = i;
+    }//if
+  }//for
+
+  if (*qtdElite < GPX_ELITE){
+    pior = (*qtdElite)++;
+  }else if (distancia >= eliteDist[pior]){
+    return;
+  }//else
+
+  memcpy(elite[pior], rota, instance.dimension * sizeof(int));
+  eliteDist[pior] = distancia;
+}//insereElite
+
+/**
+ * @brief Recombina a melhor rota elite com as demais utilizando GPX
+ *
+ * @param instance instancia a ser considerada
+ * @param elite conjunto de rotas elite
+ * @param eliteDist custo de cada rota elite
+ * @param qtdElite quantidade de rotas no conjunto
+ * @param filho vetor de trabalho onde será gravada a melhor rota obtida
+ * @param area área de trabalho usada pelo GPX
+ * @return float custo da melhor rota obtida
+ */
+static float recombinaElite(Instance instance, int **elite, float *eliteDist, int *qtdElite, int *filho, AreaTrabalho *area){
+  int melhor = 0;
+  float distancia;
+  float minDistancia;
+
+  for (int i = 1; i < *qtdElite; i++){
+    if (eliteDist[i] < eliteDist[melhor]){
+      melhor = i;
+    }//if
+  }//for
+
+  minDistancia = eliteDist[melhor];
+  memcpy(filho, elite[melhor], instance.dimension * sizeof(int));
+
+  for (int i = 0; i < *qtdElite; i++){
+    if (i == melhor){
+      continue;
+    }//if
+    distancia = gpx(instance, elite[melhor], elite[i], filho, area);
+    if (distancia < minDistancia - 0.001){
+      insereElite(instance, elite, eliteDist, qtdElite, filho, distancia);
+      return recombinaElite(instance, elite, eliteDist, qtdElite, filho, area);
+    }//if
+  }//for
+
+  memcpy(filho, elite[melhor], instance.dimension * sizeof(int));
+  return minDistancia;
+}//recombinaElite
+
+/**
+ * @brief Calcula o índice da célula da grade que contém uma coordenada
+ *
+ * @param grade índice espacial
+ * @param p coordenada consultada
+ * @return int índice linear da célula
+ */
+static int celulaGrade(Grade grade, Coordenada p){
+  int cx = (int)((p.x - grade.minX) / grade.tamCelula);
+  int cy = (int)((p.y - grade.minY) / grade.tamCelula);
+  int cz = (int)((p.z - grade.minZ) / grade.tamCelula);
+
+  cx = cx < 0 ? 0 : (cx >= grade.nx ? grade.nx - 1 : cx);
+  cy = cy < 0 ? 0 : (cy >= grade.ny ? grade.ny - 1 : cy);
+  cz = cz < 0 ? 0 : (cz >= grade.nz ? grade.nz - 1 : cz);
+  return (cz * grade.ny + cy) * grade.nx + cx;
+}//celulaGrade
+
+/**
+ * @brief Constrói uma grade uniforme sobre a caixa envolvente da instância
+ *
+ * O tamanho da célula é escolhido para que haja, em média, cerca de dois
+ * vértices por célula. Os vértices são agrupados por célula (counting sort).
+ *
+ * @param instance instancia a ser indexada
+ * @return Grade índice espacial da instância
+ */
+static Grade construirGrade(Instance instance){
+  Grade grade;
+  int n = instance.dimension;
+  float maxX, maxY, maxZ;
+  double volume;
+  int celulas, c;
+  int *posicao;
+
+  grade.minX = maxX = instance.nodes[0].x;
+  grade.minY = maxY = instance.nodes[0].y;
+  grade.minZ = maxZ = instance.nodes[0].z;
+  for (int i = 1; i < n; i++){
+    grade.minX = fminf(grade.minX, instance.nodes[i].x);
+    grade.minY = fminf(grade.minY, instance.nodes[i].y);
+    grade.minZ = fminf(grade.minZ, instance.nodes[i].z);
+    maxX = fmaxf(maxX, instance.nodes[i].x);
+    maxY = fmaxf(maxY, instance.nodes[i].y);
+    maxZ = fmaxf(maxZ, instance.nodes[i].z);
+  }//for
+
+  // Evita dimensões nulas em instâncias planas
+  volume = fmax(maxX - grade.minX, 1e-3) * fmax(maxY - grade.minY, 1e-3) * fmax(maxZ - grade.minZ, 1e-3);
+  grade.tamCelula = cbrt(volume / (n / 2.0 + 1));
+  grade.nx = (int)((maxX - grade.minX) / grade.tamCelula) + 1;
+  grade.ny = (int)((maxY - grade.minY) / grade.tamCelula) + 1;
+  grade.nz = (int)((maxZ - grade.minZ) / grade.tamCelula) + 1;
+  celulas = grade.nx * grade.ny * grade.nz;
+
+  grade.inicio = (int *)calloc(celulas + 1, sizeof(int));
+  grade.vertices = (int *)malloc(n * sizeof(int));
+  posicao = (int *)malloc(celulas * sizeof(int));
+
+  // Conta os vértices de cada célula e calcula os inícios
+  for (int i = 0; i < n; i++){
+    grade.inicio[celulaGrade(grade, instance.nodes[i]) + 1]++;
+  }//for
+  for (c = 0; c < celulas; c++){
+    grade.inicio[c + 1] += grade.inicio[c];
+    posicao[c] = grade.inicio[c];
+  }//for
+  for (int i = 0; i < n; i++){
+    grade.vertices[posicao[celulaGrade(grade, instance.nodes[i])]++] = i;
+  }//for
+
+  free(posicao);
+  return grade;
+}//construirGrade
+
+/**
+ * @brief Libera a memória de uma grade
+ *
+ * @param grade grade a ser liberada
+ */
+static void liberaGrade(Grade grade){
+  free(grade.inicio);
+  free(grade.vertices);
+}//liberaGrade
+
+/**
+ * @brief Localiza os k vértices mais próximos de uma coordenada usando a grade
+ *
+ * As células são visitadas em cascas cúbicas crescentes ao redor da célula da
+ * coordenada; a busca termina quando a casca seguinte não pode conter vértice
+ * mais próximo que o k-ésimo encontrado.
+ *
+ * @param instance instancia indexada
+ * @param grade índice espacial da instância
+ * @param p coordenada consultada
+ * @param ignorado vértice a ser desconsiderado (-1 para nenhum)
+ * @param k quantidade de vizinhos
+ * @param vizinhos vetor de saída com os vizinhos em ordem crescente de distância
+ * @param dists vetor de trabalho (k posições) com as distâncias ao quadrado
+ * @return int quantidade de vizinhos encontrados
+ */
+static int vizinhosProximos(Instance instance, Grade grade, Coordenada p, int ignorado, int k, int *vizinhos, float *dists){
+  int cx = (int)((p.x - grade.minX) / grade.tamCelula);
+  int cy = (int)((p.y - grade.minY) / grade.tamCelula);
+  int cz = (int)((p.z - grade.minZ) / grade.tamCelula);
+  int maxCasca = grade.nx + grade.ny + grade.nz;
+  int encontrados = 0;
+  int x, y, z, c, v, j;
+  float d, dx, dy, dz, limite;
+
+  cx = cx < 0 ? 0 : (cx >= grade.nx ? grade.nx - 1 : cx);
+  cy = cy < 0 ? 0 : (cy >= grade.ny ? grade.ny - 1 : cy);
+  cz = cz < 0 ? 0 : (cz >= grade.nz ? grade.nz - 1 : cz);
+
+  for (int r = 0; r <= maxCasca; r++){
+    for (z = cz - r; z <= cz + r; z++){
+      if (z < 0 || z >= grade.nz) continue;
+      for (y = cy - r; y <= cy + r; y++){
+        if (y < 0 || y >= grade.ny) continue;
+        for (x = cx - r; x <= cx + r; x++){
+          if (x < 0 || x >= grade.nx) continue;
+          // Apenas as células da superfície da casca
+          if (abs(x - cx) != r && abs(y - cy) != r && abs(z - cz) != r) continue;
+
+          c = (z * grade.ny + y) * grade.nx + x;
+          for (int i = grade.inicio[c]; i < grade.inicio[c + 1]; i++){
+            v = grade.vertices[i];
+            if (v == ignorado) continue;
+            dx = instance.nodes[v].x - p.x;
+            dy = instance.nodes[v].y - p.y;
+            dz = instance.nodes[v].z - p.z;
+            d = dx * dx + dy * dy + dz * dz;
+            if (encontrados == k && d >= dists[k - 1]) continue;
+
+            // Insere ordenado na lista dos k mais próximos
+            j = encontrados < k ? encontrados++ : k - 1;
+            while (j > 0 && dists[j - 1] > d){
+              dists[j] = dists[j - 1];
+              vizinhos[j] = vizinhos[j - 1];
+              j--;
+            }//while
+            dists[j] = d;
+            vizinhos[j] = v;
+          }//for
+        }//for
+      }//for
+    }//for
+
+    // Vértices fora da casca r estão a pelo menos r células de distância
+    limite = r * grade.tamCelula;
+    if (encontrados == k && dists[k - 1] <= limite * limite){
+      break;
+    }//if
+  }//for
+
+  return encontrados;
+}//vizinhosProximos
+
+/**
+ * @brief Constrói o grafo candidato com os k vizinhos mais próximos de cada vértice
+ *
+ * @param instance instancia a ser considerada
+ * @param grade índice espacial da instância
+ * @param k quantidade de vizinhos por vértice
+ * @return int* vetor (dimension x k) com os vizinhos de cada vértice
+ */
+static int *construirCandidatos(Instance instance, Grade grade, int k){
+  int *candidatos = (int *)malloc((size_t)instance.dimension * k * sizeof(int));
+  float *dists = (float *)malloc(k * sizeof(float));
+
+  for (int i = 0; i < instance.dimension; i++){
+    vizinhosProximos(instance, grade, instance.nodes[i], i, k, &candidatos[(size_t)i * k], dists);
+  }//for
+
+  free(dists);
+  return candidatos;
+}//construirCandidatos
+
+/**
+ * @brief Compara duas arestas pelo peso (utilizada no qsort)
+ */
+static int comparaAresta(const void *a, const void *b){
+  float pa = ((Aresta *)a)->peso;
+  float pb = ((Aresta *)b)->peso;
+  return (pa > pb) - (pa < pb);
+}//comparaAresta
+
+/**
+ * @brief Calcula o 1-tree mínimo sobre o grafo candidato com as penalidades pi
+ *
+ * A árvore geradora mínima dos vértices 1..n-1 é obtida por Kruskal; o vértice
+ * 0 é ligado pelas suas duas arestas mais baratas. O grafo candidato deve
+ * conter uma árvore geradora dos vértices 1..n-1 (ver limiteInferior).
+ *
+ * @param instance instancia a ser considerada
+ * @param arestas arestas do grafo candidato (pesos são reescritos)
+ * @param m quantidade de arestas
+ * @param pi penalidades de cada vértice
+ * @param grau vetor de saída com o grau de cada vértice no 1-tree
+ * @param conjunto vetor de trabalho do union-find
+ * @return double custo do 1-tree com as penalidades
+ */
+static double umTreeCandidato(Instance instance, Aresta *arestas, int m, double *pi, int *grau, int *conjunto){
+  int n = instance.dimension;
+  int componentes = n - 1;
+  int ru, rv, melhorU, melhorV;
+  double custo = 0, peso;
+  double menor0[2] = {INFINITY, INFINITY};
+
+  for (int i = 0; i < m; i++){
+    arestas[i].peso = arestas[i].distancia + pi[arestas[i].u] + pi[arestas[i].v];
+  }//for
+  qsort(arestas, m, sizeof(Aresta), comparaAresta);
+
+  for (int i = 0; i < n; i++){
+    conjunto[i] = i;
+    grau[i] = 0;
+  }//for
+
+  for (int i = 0; i < m && componentes > 1; i++){
+    if (arestas[i].u == 0 || arestas[i].v == 0){
+      continue;
+    }//if
+    ru = gpxRaiz(conjunto, arestas[i].u);
+    rv = gpxRaiz(conjunto, arestas[i].v);
+    if (ru != rv){
+      conjunto[ru] = rv;
+      custo += arestas[i].peso;
+      grau[arestas[i].u]++;
+      grau[arestas[i].v]++;
+      componentes--;
+    }//if
+  }//for
+
+  // Liga o vértice 0 pelas duas arestas mais baratas
+  melhorU = melhorV = 1;
+  for (int v = 1; v < n; v++){
+    peso = distance(0, v, instance) + pi[0] + pi[v];
+    if (peso < menor0[0]){
+      menor0[1] = menor0[0];
+      melhorV = melhorU;
+      menor0[0] = peso;
+      melhorU = v;
+    }else if (peso < menor0[1]){
+      menor0[1] = peso;
+      melhorV = v;
+    }//else
+  }//for
+  grau[0] = 2;
+  grau[melhorU]++;
+  grau[melhorV]++;
+  custo += menor0[0] + menor0[1];
+
+  return custo;
+}//umTreeCandidato
+
+/**
+ * @brief Peso de uma aresta com as penalidades (simétrico em u e v)
+ */
+static double pesoPenalizado(Instance instance, double *pi, int u, int v){
+  return distance(u, v, instance) + (pi[u] + pi[v]);
+}//pesoPenalizado
+
+/**
+ * @brief Ordem total das arestas: peso e, nos empates, os índices dos extremos
+ *
+ * A ordem consistente impede que o Borůvka forme ciclos com arestas de mesmo peso.
+ */
+static bool arestaMenor(double peso, int u, int v, double pesoRef, int uRef, int vRef){
+  int a = u < v ? u : v, b = u < v ? v : u;
+  int aRef = uRef < vRef ? uRef : vRef, bRef = uRef < vRef ? vRef : uRef;
+
+  if (peso != pesoRef) return peso < pesoRef;
+  if (a != aRef) return a < aRef;
+  return b < bRef;
+}//arestaMenor
+
+/**
+ * @brief Distância, em um eixo, de uma coordenada até a faixa de uma célula da grade
+ *
+ * A última faixa é aberta, pois celulaGrade coloca nela os vértices que o
+ * arredondamento deixa além da caixa envolvente; uma pequena folga cobre os
+ * arredondamentos no início das faixas.
+ *
+ * @param p coordenada relativa ao mínimo da grade
+ * @param c índice da faixa
+ * @param total quantidade de faixas no eixo
+ * @param tamCelula lado da célula
+ * @return double distância até a faixa (0 se estiver dentro dela)
+ */
+static double distanciaFaixa(double p, int c, int total, double tamCelula){
+  double inicio = (c - 0.01) * tamCelula;
+  double fim = c == total - 1 ? INFINITY : (c + 1.01) * tamCelula;
+
+  return p < inicio ? inicio - p : (p > fim ? p - fim : 0);
+}//distanciaFaixa
+
+/**
+ * @brief Calcula o 1-tree mínimo no grafo completo (Borůvka sobre a grade)
+ *
+ * Em cada rodada, cada componente procura a aresta mais barata que sai dele.
+ * As arestas do grafo candidato dão o primeiro valor a ser batido; a busca na
+ * grade percorre cascas crescentes ao redor de cada vértice e descarta as
+ * células do próprio componente e as que, pela distância até a célula e pela
+ * menor penalidade nela, não podem conter aresta mais barata. O resultado é
+ * exato, em O(n log n) rodadas de buscas locais nas instâncias usuais.
+ *
+ * @param instance instancia a ser considerada
+ * @param grade índice espacial da instância
+ * @param candidatos grafo candidato (dimension x k)
+ * @param k quantidade de vizinhos por vértice
+ * @param pi penalidades de cada vértice
+ * @param arvore vetor de saída com as n-2 arestas da árvore dos vértices 1..n-1 (ou NULL)
+ * @return double custo do 1-tree com as penalidades (INFINITY se faltar memória)
+ */
+static double umTreeGrade(Instance instance, Grade grade, int *candidatos, int k, double *pi, Aresta *arvore){
+  int n = instance.dimension;
+  int celulas = grade.nx * grade.ny * grade.nz;
+  int maxCasca = grade.nx + grade.ny + grade.nz;
+  int *conjunto = (int *)malloc(n * sizeof(int));
+  int *componente = (int *)malloc(n * sizeof(int));
+  int *melhorU = (int *)malloc(n * sizeof(int));
+  int *melhorV = (int *)malloc(n * sizeof(int));
+  double *melhorPeso = (double *)malloc(n * sizeof(double));
+  int *celulaComp = (int *)malloc(celulas * sizeof(int));   // Componente único da célula (-1 misto, -2 vazia)
+  double *celulaPi = (double *)malloc(celulas * sizeof(double)); // Menor penalidade da célula
+  int componentes = n - 1, arestas = 0;
+  int c, u, v, w, ru, rv, cu, cx, cy, cz, x, y, z, passoX;
+  double custo = 0, peso, menorPi = INFINITY, distCelula, dx, dy, dz;
+  double menor0[2] = {INFINITY, INFINITY};
+  Coordenada p;
+
+  if (conjunto == NULL || componente == NULL || melhorU == NULL || melhorV == NULL ||
+      melhorPeso == NULL || celulaComp == NULL || celulaPi == NULL){
+    custo = INFINITY;
+    componentes = 1;
+  }//if
+
+  for (c = 0; componentes > 1 && c < celulas; c++){
+    celulaPi[c] = INFINITY;
+    for (int i = grade.inicio[c]; i < grade.inicio[c + 1]; i++){
+      v = grade.vertices[i];
+      if (v != 0 && pi[v] < celulaPi[c]) celulaPi[c] = pi[v];
+    }//for
+    if (celulaPi[c] < menorPi) menorPi = celulaPi[c];
+  }//for
+  for (v = 0; v < n && conjunto != NULL; v++){
+    conjunto[v] = v;
+  }//for
+
+  while (componentes > 1){
+    for (v = 1; v < n; v++){
+      componente[v] = gpxRaiz(conjunto, v);
+      melhorPeso[componente[v]] = INFINITY;
+    }//for
+    for (c = 0; c < celulas; c++){
+      celulaComp[c] = -2;
+      for (int i = grade.inicio[c]; i < grade.inicio[c + 1]; i++){
+        v = grade.vertices[i];
+        if (v == 0) continue;
+        celulaComp[c] = celulaComp[c] == -2 || celulaComp[c] == componente[v] ? componente[v] : -1;
+        if (celulaComp[c] == -1) break;
+      }//for
+    }//for
+
+    // Arestas candidatas dão o primeiro valor a ser batido em cada componente
+    for (v = 1; v < n; v++){
+      for (int j = 0; j < k; j++){
+        w = candidatos[(size_t)v * k + j];
+        if (w == 0 || componente[w] == componente[v]) continue;
+        peso = pesoPenalizado(instance, pi, v, w);
+        cu = componente[v];
+        if (arestaMenor(peso, v, w, melhorPeso[cu], melhorU[cu], melhorV[cu])){
+          melhorPeso[cu] = peso;
+          melhorU[cu] = v;
+          melhorV[cu] = w;
+        }//if
+      }//for
+    }//for
+
+    // Busca exata na grade, em cascas crescentes ao redor de cada vértice
+    for (v = 1; v < n; v++){
+      cu = componente[v];
+      p = instance.nodes[v];
+      c = celulaGrade(grade, p);
+      cx = c % grade.nx;
+      cy = (c / grade.nx) % grade.ny;
+      cz = c / (grade.nx * grade.ny);
+      for (int r = 0; r <= maxCasca; r++){
+        // Vértices da casca r estão a pelo menos r-1 células de distância
+        if (r > 1 && (r - 1.01) * grade.tamCelula + pi[v] + menorPi > melhorPeso[cu]) break;
+        for (z = cz - r; z <= cz + r; z++){
+          if (z < 0 || z >= grade.nz) continue;
+          for (y = cy - r; y <= cy + r; y++){
+            if (y < 0 || y >= grade.ny) continue;
+            // Fora das faces z e y da casca, apenas as duas células extremas em x
+            passoX = (abs(z - cz) == r || abs(y - cy) == r || r == 0) ? 1 : 2 * r;
+            for (x = cx - r; x <= cx + r; x += passoX){
+              if (x < 0 || x >= grade.nx) continue;
+              c = (z * grade.ny + y) * grade.nx + x;
+              if (celulaComp[c] == -2 || celulaComp[c] == cu) continue;
+              dx = distanciaFaixa(p.x - grade.minX, x, grade.nx, grade.tamCelula);
+              dy = distanciaFaixa(p.y - grade.minY, y, grade.ny, grade.tamCelula);
+              dz = distanciaFaixa(p.z - grade.minZ, z, grade.nz, grade.tamCelula);
+              distCelula = sqrt(dx * dx + dy * dy + dz * dz);
+              if (distCelula + pi[v] + celulaPi[c] > melhorPeso[cu]) continue;
+              for (int i = grade.inicio[c]; i < grade.inicio[c + 1]; i++){
+                w = grade.vertices[i];
+                if (w == 0 || componente[w] == cu) continue;
+                peso = pesoPenalizado(instance, pi, v, w);
+                if (arestaMenor(peso, v, w, melhorPeso[cu], melhorU[cu], melhorV[cu])){
+                  melhorPeso[cu] = peso;
+                  melhorU[cu] = v;
+                  melhorV[cu] = w;
+                }//if
+              }//for
+            }//for
+          }//for
+        }//for
+      }//for
+    }//for
+
+    // Une cada componente pela sua aresta mais barata
+    for (v = 1; v < n; v++){
+      if (componente[v] != v) continue;
+      ru = gpxRaiz(conjunto, melhorU[v]);
+      rv = gpxRaiz(conjunto, melhorV[v]);
+      if (ru != rv){
+        conjunto[ru] = rv;
+        custo += melhorPeso[v];
+        if (arvore != NULL){
+          arvore[arestas].u = melhorU[v];
+          arvore[arestas].v = melhorV[v];
+          arvore[arestas].distancia = distance(melhorU[v], melhorV[v], instance);
+        }//if
+        arestas++;
+        componentes--;
+      }//if
+    }//for
+  }//while
+
+  // Liga o vértice 0 pelas duas arestas mais baratas
+  for (v = 1; v < n && custo < INFINITY; v++){
+    peso = pesoPenalizado(instance, pi, 0, v);
+    if (peso < menor0[0]){
+      menor0[1] = menor0[0];
+      menor0[0] = peso;
+    }else if (peso < menor0[1]){
+      menor0[1] = peso;
+    }//else
+  }//for
+  custo += menor0[0] + menor0[1];
+
+  free(conjunto);
+  free(componente);
+  free(melhorU);
+  free(melhorV);
+  free(melhorPeso);
+  free(celulaComp);
+  free(celulaPi);
+  return custo;
+}//umTreeGrade
+
+/**
+ * @brief Calcula um limite inferior para a instância (1-tree + subgradiente de Held-Karp)
+ *
+ * O grafo candidato recebe uma vez as arestas da árvore geradora mínima
+ * euclidiana, ficando conexo; sobre ele o 1-tree é recalculado a cada passo
+ * do subgradiente, que ajusta as penalidades dos vértices. O limite final é
+ * calculado com as melhores penalidades no grafo completo (umTreeGrade) e é
+ * sempre garantido.
+ *
+ * @param instance instancia a ser considerada
+ * @param grade índice espacial da instância
+ * @param candidatos grafo candidato (dimension x k)
+ * @param k quantidade de vizinhos por vértice
+ * @param limiteSuperior custo de uma rota conhecida (usado no passo do subgradiente)
+ * @return float limite inferior para o custo da rota ótima
+ */
+static float limiteInferior(Instance instance, Grade grade, int *candidatos, int k, float limiteSuperior){
+  int n = instance.dimension;
+  int m = 0;
+  Aresta *arestas = (Aresta *)malloc(((size_t)n * k + n) * sizeof(Aresta));
+  double *pi = (double *)calloc(n, sizeof(double));
+  double *melhorPi = (double *)calloc(n, sizeof(double));
+  int *grau = (int *)malloc(n * sizeof(int));
+  int *conjunto = (int *)malloc(n * sizeof(int));
+  double lambda = 2;
+  double valor, somaPi, normaG, passo;
+  double melhor = -INFINITY;
+  int semMelhora = 0;
+
+  // Arestas do grafo candidato
+  for (int i = 0; i < n; i++){
+    for (int j = 0; j < k; j++){
+      arestas[m].u = i;
+      arestas[m].v = candidatos[(size_t)i * k + j];
+      arestas[m].distancia = distance(arestas[m].u, arestas[m].v, instance);
+      m++;
+    }//for
+  }//for
+  // Árvore geradora mínima euclidiana (penalidades nulas)
+  if (umTreeGrade(instance, grade, candidatos, k, pi, arestas + m) < INFINITY){
+    m += n - 2;
+  }//if
+
+  for (int it = 0; it < LB_ITERACOES && lambda > 1e-4; it++){
+    valor = umTreeCandidato(instance, arestas, m, pi, grau, conjunto);
+    somaPi = 0;
+    normaG = 0;
+    for (int i = 0; i < n; i++){
+      somaPi += pi[i];
+      normaG += (grau[i] - 2) * (grau[i] - 2);
+    }//for
+    valor -= 2 * somaPi;
+
+    if (valor > melhor){
+      melhor = valor;
+      memcpy(melhorPi, pi, n * sizeof(double));
+      semMelhora = 0;
+    }else if (++semMelhora >= 5){
+      lambda /= 2;
+      semMelhora = 0;
+    }//else
+
+    // Todos os vértices com grau 2: o 1-tree é uma rota ótima
+    if (normaG == 0){
+      break;
+    }//if
+
+    passo = lambda * (limiteSuperior - valor) / normaG;
+    for (int i = 0; i < n; i++){
+      pi[i] += passo * (grau[i] - 2);
+    }//for
+  }//for
+
+  // O 1-tree do grafo candidato pode ser mais caro que o do grafo completo
+  somaPi = 0;
+  for (int i = 0; i < n; i++){
+    somaPi += melhorPi[i];
+  }//for
+  melhor = umTreeGrade(instance, grade, candidatos, k, melhorPi, NULL) - 2 * somaPi;
+  if (melhor == INFINITY){
+    melhor = 0; // Sem memória para o grafo completo: só o limite trivial é garantido
+  }//if
+
+  free(arestas);
+  free(pi);
+  free(melhorPi);
+  free(grau);
+  free(conjunto);
+
+  return melhor;
+}//limiteInferior
+
+//Funções auxiliares para exibir o tempo durante a execução
+
+
+/**
+ * @brief Calcula a diferença de tempo em segundos um timestamp e o tempo atual
+ * 
+ * @param initialTick tempo inicial
+ * @return double diferença entre os tempos em segundos
+ */
+static double calculaTempo(clock_t initialTick){
+  return (double)(clock() - initialTick) / (CLOCKS_PER_SEC);
+}
+
+/**
+ * @brief Calcula a diferença de tempo em segundos entre 2 timestamps
+ * 
+ * @param initialTick tempo inicial
+ * @param finalTick tempo final
+ * @return double diferença entre os tempos em segundos
+ */
+static double calculaDiferencaTempo(clock_t initialTick, clock_t finalTick){
+  return (double)(finalTick - initialTick) / (CLOCKS_PER_SEC);
+}
+
+/**
+ * @brief Retorna o tempo de relógio atual em segundos
+ *
+ * Diferente do clock(), não soma o tempo de processador de todas as threads.
+ *
+ * @return double tempo em segundos a partir de um instante arbitrário
+ */
+static double tempoAtual(){
+  struct timespec agora;
+  clock_gettime(CLOCK_MONOTONIC, &agora);
+  return agora.tv_sec + agora.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Gera um número aleatório usando a semente da thread atual
+ *
+ * @return int número aleatório entre 0 e RAND_MAX
+ */
+static int aleatorio(){
+  return rand_r(&semente);
+}
+
+#ifndef TSP_BIBLIOTECA
+/**
+ * @brief Gera uma string contendo o timestamp
+ * 
+ * @param buffer vetor (com pelo menos 100 posições) onde será gravado o timestamp com data e hora
+ */
+static void getTimeStamp(char *buffer){
+  time_t rawtime;
+  struct tm timeinfo;
+
+
+  time ( &rawtime );
+  localtime_r ( &rawtime, &timeinfo );
+
+  sprintf(buffer, "%02d %02d %04d %02d:%02d:%02d", timeinfo.tm_mday,
+            timeinfo.tm_mon + 1, timeinfo.tm_year + 1900,
+            timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+
+}//timeStamp
+
+/**
+ * @brief Função criada para avaliar o alpha do GRASP
+ * 
+ * @param instance instancia a ser avaliada
+ * @param runs quantidade de execuções para cada valor de alpha
+ */
+static void evaluateAlpha(Instance instance, int runs){
+  FILE* logFile;
+
+  float alpha;
+  int* melhorRota = (int*) malloc(instance.dimension * sizeof(int));
+
+  int *rota = NULL;
+  float distancia;
+  float distanciaGrasp;
+  float minDistancia = INFINITY;
+ 
+    logFile = createLogFile( instance );
+    //Escreve o cabeçalho no arquivo de log
+    for ( alpha = 0; alpha <= 1; alpha = alpha + 0.025)
+    {
+      if(alpha==0){
+        fprintf(logFile,"%f",alpha);
+      }else{
+        fprintf(logFile,",%f",alpha);
+      }//else
+    }
+    fprintf(logFile,"\n");
+    minDistancia = INFINITY;
+    printf("Alpha %f\n",alpha);
+
+  //Executa o algoritmo "runs" vezes
+  for (int i = 1; i <= runs; i++)
+  {
     //Para cada valor de alpha
     for ( alpha = 0; alpha <= 1; alpha = alpha + 0.025)
     {
     free(rota);
 
-    rota = geraRotaGrasp(instance, alpha);
-    
-    distanciaGrasp = fitness(instance, rota);
+    rota = geraRotaGrasp(instance, alpha);
+    
+    distanciaGrasp = fitness(instance, rota);
+
+    distancia = run2optFirst(instance, rota);
+  
+    if (distancia < minDistancia)
+    {
+      minDistancia = distancia;
+      memcpy(melhorRota,rota,instance.dimension * sizeof(int));
+      saveTour(instance,melhorRota);
+    }
+
+      //Salva os valores obtidos no log
+      if(alpha==0){
+        fprintf(logFile,"%f", distancia);// primeita coluna csv
+      }else{
+        fprintf(logFile,",%f", distancia);// demais colunas
+      }//else
+      fflush(logFile);
+      
+    }//forAlpha
+    fprintf(logFile,"\n" );
+  } // forExecutions
+
+  //Fecha arquivo de log
+  fclose(logFile);
+}
+#endif // TSP_BIBLIOTECA
+
+
+/**
+ * @brief Cria um pool de trabalho com uma fila de tarefas por trabalhador
+ *
+ * @param qtdTrabalhadores quantidade de threads do pool
+ * @param capacidade quantidade máxima de tarefas submetidas
+ * @return PoolTrabalho* pool criado (NULL se faltar memória)
+ */
+static PoolTrabalho *criaPool(int qtdTrabalhadores, int capacidade){
+  PoolTrabalho *pool = (PoolTrabalho *)malloc(sizeof(PoolTrabalho));
+
+  if (pool == NULL){
+    return NULL;
+  }//if
+  pool->qtdTrabalhadores = qtdTrabalhadores;
+  pool->proximaFila = 0;
+  pool->filas = (FilaTrabalho *)malloc(qtdTrabalhadores * sizeof(FilaTrabalho));
+  if (pool->filas == NULL){
+    free(pool);
+    return NULL;
+  }//if
+  for (int i = 0; i < qtdTrabalhadores; i++){
+    pool->filas[i].tarefas = (Tarefa *)malloc(capacidade * sizeof(Tarefa));
+    if (pool->filas[i].tarefas == NULL){
+      // Libera apenas as filas já criadas
+      pool->qtdTrabalhadores = i;
+      liberaPool(pool);
+      return NULL;
+    }//if
+    pool->filas[i].inicio = 0;
+    pool->filas[i].fim = 0;
+    pthread_mutex_init(&pool->filas[i].trava, NULL);
+  }//for
+
+  return pool;
+}//criaPool
+
+/**
+ * @brief Submete uma tarefa ao pool, distribuindo as filas em rodízio
+ *
+ * Cada trabalhador executa sua fila na ordem de submissão, então as tarefas
+ * mais longas devem ser submetidas primeiro.
+ *
+ * @param pool pool de trabalho
+ * @param funcao função a ser executada
+ * @param argumento argumento passado para a função
+ */
+static void submetePool(PoolTrabalho *pool, void (*funcao)(void *), void *argumento){
+  FilaTrabalho *fila = &pool->filas[pool->proximaFila];
+
+  fila->tarefas[fila->fim].funcao = funcao;
+  fila->tarefas[fila->fim].argumento = argumento;
+  fila->fim++;
+  pool->proximaFila = (pool->proximaFila + 1) % pool->qtdTrabalhadores;
+}//submetePool
+
+/**
+ * @brief Retira uma tarefa do início da própria fila ou rouba do fim de outra
+ *
+ * @param pool pool de trabalho
+ * @param trabalhador índice do trabalhador
+ * @param tarefa tarefa obtida
+ * @return true se uma tarefa foi obtida
+ */
+static bool obtemTarefa(PoolTrabalho *pool, int trabalhador, Tarefa *tarefa){
+  FilaTrabalho *fila;
+
+  for (int i = 0; i < pool->qtdTrabalhadores; i++){
+    fila = &pool->filas[(trabalhador + i) % pool->qtdTrabalhadores];
+    pthread_mutex_lock(&fila->trava);
+    if (fila->inicio < fila->fim){
+      // O dono pega as tarefas maiores; os ladrões, as menores
+      *tarefa = i == 0 ? fila->tarefas[fila->inicio++] : fila->tarefas[--fila->fim];
+      pthread_mutex_unlock(&fila->trava);
+      return true;
+    }//if
+    pthread_mutex_unlock(&fila->trava);
+  }//for
+
+  return false;
+}//obtemTarefa
+
+typedef struct
+{
+  PoolTrabalho *pool;
+  int trabalhador;
+  bool criada;      // A thread do trabalhador foi criada
+} ArgTrabalhador;
+
+/**
+ * @brief Laço de uma thread do pool: executa tarefas até todas as filas esvaziarem
+ */
+static void *trabalhadorPool(void *arg){
+  ArgTrabalhador *dados = (ArgTrabalhador *)arg;
+  Tarefa tarefa;
+
+  trabalhadorAtual = dados->trabalhador;
+  while (obtemTarefa(dados->pool, dados->trabalhador, &tarefa)){
+    tarefa.funcao(tarefa.argumento);
+  }//while
+
+  return NULL;
+}//trabalhadorPool
+
+/**
+ * @brief Executa todas as tarefas submetidas e aguarda o término
+ *
+ * Se o sistema não criar a thread de um trabalhador, ele é executado na
+ * thread que chamou, roubando as tarefas que restarem.
+ *
+ * @param pool pool de trabalho
+ * @return bool false se faltar memória (nenhuma tarefa é executada)
+ */
+static bool executaPool(PoolTrabalho *pool){
+  pthread_t *threads = (pthread_t *)malloc(pool->qtdTrabalhadores * sizeof(pthread_t));
+  ArgTrabalhador *args = (ArgTrabalhador *)malloc(pool->qtdTrabalhadores * sizeof(ArgTrabalhador));
+  int trabalhadorAnterior = trabalhadorAtual;
+
+  if (threads == NULL || args == NULL){
+    free(threads);
+    free(args);
+    return false;
+  }//if
+
+  for (int i = 0; i < pool->qtdTrabalhadores; i++){
+    args[i].pool = pool;
+    args[i].trabalhador = i;
+    args[i].criada = pthread_create(&threads[i], NULL, trabalhadorPool, &args[i]) == 0;
+  }//for
+  for (int i = 0; i < pool->qtdTrabalhadores; i++){
+    if (!args[i].criada){
+      trabalhadorPool(&args[i]);
+      trabalhadorAtual = trabalhadorAnterior;
+    }//if
+  }//for
+  for (int i = 0; i < pool->qtdTrabalhadores; i++){
+    if (args[i].criada){
+      pthread_join(threads[i], NULL);
+    }//if
+  }//for
+
+  free(threads);
+  free(args);
+  return true;
+}//executaPool
+
+/**
+ * @brief Libera a memória de um pool de trabalho
+ *
+ * @param pool pool a ser liberado
+ */
+static void liberaPool(PoolTrabalho *pool){
+  for (int i = 0; i < pool->qtdTrabalhadores; i++){
+    free(pool->filas[i].tarefas);
+    pthread_mutex_destroy(&pool->filas[i].trava);
+  }//for
+  free(pool->filas);
+  free(pool);
+}//liberaPool
+
+/**
+ * @brief Executa reinícios de construção + busca local até o limite de execuções ou de tempo
+ *
+ * Se opcoes.execucoes e opcoes.tempoLimite forem 0, executa uma única iteração.
+ *
+ * @param instance instancia a ser considerada
+ * @param opcoes construção, busca local e limites utilizados
+ * @param melhorRota vetor onde será gravada a melhor rota encontrada
+ * @param melhorDistancia custo da melhor rota encontrada
+ * @param area área de trabalho do trabalhador (nenhuma alocação é feita no laço)
+ * @return int quantidade de iterações executadas
+ */
+static int multiInicio(Instance instance, TspOpcoes opcoes, int *melhorRota, float *melhorDistancia, AreaTrabalho *area){
+  double inicio = tempoAtual();
+  int iteracoes = 0;
+  int *rota = area->rota;
+  float distancia;
+
+  *melhorDistancia = INFINITY;
+  do
+  {
+    switch (opcoes.construcao){
+      case TSP_CONSTRUCAO_GULOSA:
+        geraRotaGulosaEm(instance, rota, area->visitados);
+        break;
+      case TSP_CONSTRUCAO_ALEATORIA:
+        geraRotaAleatoriaEm(instance.dimension, rota);
+        break;
+      default:
+        geraRotaGraspEm(instance, opcoes.alpha * (aleatorio()%5 + 1) / 5, rota, area->visitados, area->lrc);
+    }//switch
+
+    switch (opcoes.buscaLocal){
+      case TSP_BUSCA_2OPT_BEST:
+        distancia = run2optBest(instance, rota);
+        break;
+      case TSP_BUSCA_NENHUMA:
+        distancia = fitness(instance, rota);
+        break;
+      default:
+        distancia = run2optFirst(instance, rota);
+    }//switch
+
+    if (distancia < *melhorDistancia){
+      *melhorDistancia = distancia;
+      memcpy(melhorRota, rota, instance.dimension * sizeof(int));
+    }//if
+    iteracoes++;
+  } while ((opcoes.execucoes == 0 || iteracoes < opcoes.execucoes) &&
+           (opcoes.tempoLimite == 0 ? opcoes.execucoes > 0 : tempoAtual() - inicio < opcoes.tempoLimite));
+
+  return iteracoes;
+}//multiInicio
+
+#ifndef TSP_BIBLIOTECA
+/**
+ * @brief Executa uma tarefa do lote: GRASP+2opt até esgotar o orçamento de tempo
+ *
+ * Pelo menos uma iteração é executada, mesmo com orçamento zero.
+ *
+ * @param arg TarefaLote a ser executada
+ */
+static void executaTarefaLote(void *arg){
+  TarefaLote *tarefa = (TarefaLote *)arg;
+  double inicio = tempoAtual();
+  AreaTrabalho *area = tarefa->areas[trabalhadorAtual];
+  TspOpcoes opcoes;
+
+  tspOpcoesPadrao(&opcoes);
+  opcoes.tempoLimite = tarefa->orcamento;
+
+  semente = tarefa->semente;
+  tarefa->trabalhador = trabalhadorAtual;
+  tarefa->distancia = INFINITY;
+  tarefa->iteracoes = multiInicio(*tarefa->instance, opcoes, tarefa->melhorRota, &tarefa->distancia, area);
+  tarefa->tempo = tempoAtual() - inicio;
+}//executaTarefaLote
+
+/**
+ * @brief Compara duas tarefas do lote pela dimensão da instância (decrescente)
+ */
+static int comparaTarefaLote(const void *a, const void *b){
+  return ((TarefaLote *)b)->instance->dimension - ((TarefaLote *)a)->instance->dimension;
+}//comparaTarefaLote
+
+/**
+ * @brief Executa um lote de experimentos descrito em um arquivo de manifesto
+ *
+ * Cada linha do manifesto contém: <arquivo .tsp> <semente> <execuções> <orçamento em segundos>.
+ * Linhas vazias ou iniciadas com # são ignoradas. Cada execução de cada
+ * instância é uma tarefa do pool; as tarefas das maiores instâncias são
+ * submetidas primeiro e as menores ocupam os núcleos que ficarem ociosos.
+ * Os resultados são gravados em uma tabela CSV na pasta results.
+ *
+ * @param manifesto caminho do arquivo de manifesto
+ * @param qtdTrabalhadores quantidade de threads
+ */
+static void executaLote(char *manifesto, int qtdTrabalhadores){
+  char linha[400];
+  char caminho[300];
+  char filename[120];
+  char timestamp[100];
+  unsigned int sementeBase;
+  int execucoes, qtdArquivos = 0, qtdTarefas = 0, melhor;
+  double orcamento;
+  double inicio = tempoAtual();
+  char **arquivos = NULL;
+  Instance **instancias = NULL;
+  TarefaLote *tarefas = NULL;
+  AreaTrabalho **areas;
+  PoolTrabalho *pool;
+  FILE *file, *tabela;
+  int a, maiorDimensao = 0;
+
+  if (qtdTrabalhadores < 1){
+    printf("Erro: o número de threads deve ser maior que zero\n");
+    exit(1);
+  }//if
 
-    distancia = run2optFirst(instance, rota);
-  
-    if (distancia < minDistancia)
-    {
-      minDistancia = distancia;
-      memcpy(melhorRota,rota,instance.dimension * sizeof(int));
-      saveTour(instance,melhorRota);
-    }
+  file = fopen(manifesto, "r");
+  if (file == NULL)
+  {
+    perror("Erro ao abrir o manifesto:");
+    exit(1);
+  } // if
 
-      //Salva os valores obtidos no log
-      if(alpha==0){
-        fprintf(logFile,"%f", distancia);// primeita coluna csv
+  // Lê o manifesto, carregando cada instância uma única vez
+  while (fgets(linha, sizeof(linha), file) != NULL){
+    if (linha[0] == '#' || sscanf(linha, "%299s", caminho) != 1){
+      continue;
+    }//if
+    if (sscanf(linha, "%299s %u %d %lf", caminho, &sementeBase, &execucoes, &orcamento) != 4 || execucoes < 0 || orcamento < 0){
+      printf("Erro: linha inválida no manifesto: %s", linha);
+      exit(1);
+    }//if
+
+    for (a = 0; a < qtdArquivos && strcmp(arquivos[a], caminho) != 0; a++);
+    if (a == qtdArquivos){
+      arquivos = (char **)realloc(arquivos, (qtdArquivos + 1) * sizeof(char *));
+      instancias = (Instance **)realloc(instancias, (qtdArquivos + 1) * sizeof(Instance *));
+      arquivos[a] = strdup(caminho);
+      instancias[a] = (Instance *)malloc(sizeof(Instance));
+      *instancias[a] = readTspFile(caminho, false);
+      qtdArquivos++;
+    }//if
+
+    tarefas = (TarefaLote *)realloc(tarefas, (qtdTarefas + execucoes) * sizeof(TarefaLote));
+    for (int i = 0; i < execucoes; i++){
+      tarefas[qtdTarefas].instance = instancias[a];
+      tarefas[qtdTarefas].arquivo = arquivos[a];
+      tarefas[qtdTarefas].execucao = i + 1;
+      tarefas[qtdTarefas].semente = sementeBase + i;
+      tarefas[qtdTarefas].orcamento = orcamento;
+      qtdTarefas++;
+    }//for
+  }//while
+  fclose(file);
+
+  // Maiores instâncias primeiro
+  qsort(tarefas, qtdTarefas, sizeof(TarefaLote), comparaTarefaLote);
+
+  // Uma área de trabalho por thread, dimensionada para a maior instância
+  for (a = 0; a < qtdArquivos; a++){
+    if (instancias[a]->dimension > maiorDimensao){
+      maiorDimensao = instancias[a]->dimension;
+    }//if
+  }//for
+  areas = (AreaTrabalho **)calloc(qtdTrabalhadores, sizeof(AreaTrabalho *));
+  for (int i = 0; i < qtdTrabalhadores; i++){
+    areas[i] = criaAreaTrabalho(maiorDimensao);
+    if (areas[i] == NULL){
+      printf("Erro: memória insuficiente para as áreas de trabalho\n");
+      exit(1);
+    }//if
+  }//for
+
+  printf("Executando %d tarefas de %d instancias com %d threads...\n", qtdTarefas, qtdArquivos, qtdTrabalhadores);
+  fflush(stdout);
+  pool = criaPool(qtdTrabalhadores, qtdTarefas);
+  if (pool == NULL){
+    printf("Erro: memória insuficiente para o pool de trabalho\n");
+    exit(1);
+  }//if
+  for (int i = 0; i < qtdTarefas; i++){
+    tarefas[i].melhorRota = (int *)malloc(tarefas[i].instance->dimension * sizeof(int));
+    tarefas[i].areas = areas;
+    submetePool(pool, executaTarefaLote, &tarefas[i]);
+  }//for
+  if (!executaPool(pool)){
+    printf("Erro: memória insuficiente para o pool de trabalho\n");
+    exit(1);
+  }//if
+  liberaPool(pool);
+  for (int i = 0; i < qtdTrabalhadores; i++){
+    liberaAreaTrabalho(areas[i]);
+  }//for
+  free(areas);
+
+  // Tabela consolidada de resultados
+  getTimeStamp(timestamp);
+  sprintf(filename,"results/Lote - %s.csv",timestamp);
+  tabela = fopen(filename,"w");
+  if (tabela == NULL)
+  {
+    perror("Erro ao criar a tabela de resultados:");
+    exit(1);
+  } // if
+  fprintf(tabela, "Arquivo,Instancia,Dimensao,Execucao,Semente,Iteracoes,Tempo,Distancia,Trabalhador\n");
+  for (int i = 0; i < qtdTarefas; i++){
+    fprintf(tabela, "%s,%s,%d,%d,%u,%d,%.3f,%f,%d\n", tarefas[i].arquivo, tarefas[i].instance->nome,
+            tarefas[i].instance->dimension, tarefas[i].execucao, tarefas[i].semente,
+            tarefas[i].iteracoes, tarefas[i].tempo, tarefas[i].distancia, tarefas[i].trabalhador);
+  }//for
+  fclose(tabela);
+
+  // Resumo por instância e melhor rota de cada uma
+  printf("\n%-20s %10s %8s %16s %16s\n", "Instancia", "Dimensao", "Exec.", "Melhor", "Media");
+  for (a = 0; a < qtdArquivos; a++){
+    double soma = 0;
+    int qtd = 0;
+    melhor = -1;
+    for (int i = 0; i < qtdTarefas; i++){
+      if (tarefas[i].instance != instancias[a]) continue;
+      soma += tarefas[i].distancia;
+      qtd++;
+      if (melhor == -1 || tarefas[i].distancia < tarefas[melhor].distancia){
+        melhor = i;
+      }//if
+    }//for
+    if (melhor == -1) continue;
+    printf("%-20s %10d %8d %16f %16f\n", instancias[a]->nome, instancias[a]->dimension, qtd, tarefas[melhor].distancia, soma / qtd);
+    saveTour(*instancias[a], tarefas[melhor].melhorRota);
+  }//for
+  printf("\nTempo total: %.1lfs\nResultados salvos em %s\n", tempoAtual() - inicio, filename);
+
+  for (int i = 0; i < qtdTarefas; i++){
+    free(tarefas[i].melhorRota);
+  }//for
+  for (a = 0; a < qtdArquivos; a++){
+    liberaInstancia(*instancias[a]);
+    free(instancias[a]);
+    free(arquivos[a]);
+  }//for
+  free(tarefas);
+  free(instancias);
+  free(arquivos);
+}//executaLote
+#endif // TSP_BIBLIOTECA
+
+
+//API da biblioteca (tsp.h)
+
+struct TspSolver
+{
+  Instance instance;
+};
+
+typedef struct
+{
+  Instance instance;
+  TspOpcoes opcoes;
+  int *melhorRota;
+  float distancia;
+  int iteracoes;
+} TarefaSolver;
+
+void tspOpcoesPadrao(TspOpcoes *opcoes){
+  opcoes->construcao = TSP_CONSTRUCAO_GRASP;
+  opcoes->buscaLocal = TSP_BUSCA_2OPT_FIRST;
+  opcoes->alpha = 0.05;
+  opcoes->threads = 1;
+  opcoes->execucoes = 0;
+  opcoes->tempoLimite = 0;
+  opcoes->semente = 1;
+  opcoes->janela = 0;
+}//tspOpcoesPadrao
+
+TspStatus tspCriaSolver(const float *coordenadas, int dimensao, TspSolver **solver){
+  if (coordenadas == NULL || solver == NULL || dimensao < 3){
+    return TSP_ERRO_PARAMETRO;
+  }//if
+  for (size_t i = 0; i < 3 * (size_t)dimensao; i++){
+    if (!isfinite(coordenadas[i])){
+      return TSP_ERRO_PARAMETRO;
+    }//if
+  }//for
+
+  *solver = (TspSolver *)malloc(sizeof(TspSolver));
+  if (*solver == NULL){
+    return TSP_ERRO_MEMORIA;
+  }//if
+
+  (*solver)->instance.nome = (char *)"memoria";
+  (*solver)->instance.tipo = (char *)"TSP";
+  (*solver)->instance.comment = (char *)"";
+  (*solver)->instance.edgeWeightType = (char *)"EUC_3D";
+  (*solver)->instance.dimension = dimensao;
+  (*solver)->instance.nodes = (Coordenada *)coordenadas; // Sem cópia: somente leitura
+  (*solver)->instance.distances = NULL;
+  (*solver)->instance.buildMatrix = false;
+
+  return TSP_OK;
+}//tspCriaSolver
+
+/**
+ * @brief Tarefa do pool do solver: reinícios independentes com a semente da tarefa
+ */
+static void executaTarefaSolver(void *arg){
+  TarefaSolver *tarefa = (TarefaSolver *)arg;
+  AreaTrabalho *area = criaAreaTrabalho(tarefa->instance.dimension);
+
+  semente = tarefa->opcoes.semente;
+  tarefa->iteracoes = area == NULL ? -1 : multiInicio(tarefa->instance, tarefa->opcoes, tarefa->melhorRota, &tarefa->distancia, area);
+  liberaAreaTrabalho(area);
+}//executaTarefaSolver
+
+TspStatus tspResolve(TspSolver *solver, const TspOpcoes *opcoes, TspResultado *resultado){
+  double inicio = tempoAtual();
+  int n, threads, qtdElite = 0;
+  TarefaSolver *tarefas;
+  PoolTrabalho *pool;
+  int *elite[GPX_ELITE];
+  float eliteDist[GPX_ELITE];
+  AreaTrabalho *area;
+  TspStatus status = TSP_OK;
+
+  if (solver == NULL || opcoes == NULL || resultado == NULL || resultado->rota == NULL ||
+      opcoes->threads < 1 || opcoes->execucoes < 0 || opcoes->tempoLimite < 0 ||
+      opcoes->alpha < 0 || opcoes->alpha > 1 ||
+      (opcoes->janela != 0 && (opcoes->janela < 3 || opcoes->janela > JANELA_MAX))){
+    return TSP_ERRO_PARAMETRO;
+  }//if
+
+  n = solver->instance.dimension;
+  // Não cria threads sem execuções a fazer
+  threads = opcoes->execucoes > 0 && opcoes->execucoes < opcoes->threads ? opcoes->execucoes : opcoes->threads;
+
+  tarefas = (TarefaSolver *)calloc(threads, sizeof(TarefaSolver));
+  if (tarefas == NULL){
+    return TSP_ERRO_MEMORIA;
+  }//if
+
+  // Divide as execuções entre as threads, cada uma com sua semente
+  pool = criaPool(threads, threads);
+  if (pool == NULL){
+    free(tarefas);
+    return TSP_ERRO_MEMORIA;
+  }//if
+  for (int i = 0; i < threads; i++){
+    tarefas[i].instance = solver->instance;
+    tarefas[i].opcoes = *opcoes;
+    tarefas[i].opcoes.semente = opcoes->semente + i;
+    if (opcoes->execucoes > 0){
+      tarefas[i].opcoes.execucoes = opcoes->execucoes / threads + (i < opcoes->execucoes % threads);
+    }//if
+    tarefas[i].melhorRota = (int *)malloc(n * sizeof(int));
+    if (tarefas[i].melhorRota == NULL){
+      status = TSP_ERRO_MEMORIA;
+    }//if
+    submetePool(pool, executaTarefaSolver, &tarefas[i]);
+  }//for
+
+  if (status == TSP_OK && !executaPool(pool)){
+    status = TSP_ERRO_MEMORIA;
+  }//if
+  liberaPool(pool);
+
+  // Combina as melhores rotas de cada thread com GPX
+  resultado->iteracoes = 0;
+  area = criaAreaTrabalho(n);
+  if (area == NULL){
+    status = TSP_ERRO_MEMORIA;
+  }//if
+  for (int i = 0; i < GPX_ELITE; i++){
+    elite[i] = (int *)malloc(n * sizeof(int));
+    if (elite[i] == NULL){
+      status = TSP_ERRO_MEMORIA;
+    }//if
+  }//for
+  for (int i = 0; i < threads && status == TSP_OK; i++){
+    if (tarefas[i].iteracoes < 0){
+      status = TSP_ERRO_MEMORIA;
+      break;
+    }//if
+    resultado->iteracoes += tarefas[i].iteracoes;
+    insereElite(solver->instance, elite, eliteDist, &qtdElite, tarefas[i].melhorRota, tarefas[i].distancia);
+  }//for
+  if (status == TSP_OK){
+    resultado->distancia = recombinaElite(solver->instance, elite, eliteDist, &qtdElite, resultado->rota, area);
+    if (opcoes->janela != 0){
+      resultado->distancia = runJanelaDP(solver->instance, resultado->rota, opcoes->janela, opcoes->threads);
+      if (resultado->distancia < 0){
+        status = TSP_ERRO_MEMORIA;
+      }//if
+    }//if
+    resultado->tempo = tempoAtual() - inicio;
+  }//if
+
+  for (int i = 0; i < GPX_ELITE; i++){
+    free(elite[i]);
+  }//for
+  for (int i = 0; i < threads; i++){
+    free(tarefas[i].melhorRota);
+  }//for
+  free(tarefas);
+  liberaAreaTrabalho(area);
+
+  return status;
+}//tspResolve
+
+void tspLiberaSolver(TspSolver *solver){
+  free(solver);
+}//tspLiberaSolver
+
+const char *tspMensagemErro(TspStatus status){
+  switch (status){
+    case TSP_OK:
+      return "Sucesso";
+    case TSP_ERRO_PARAMETRO:
+      return "Parametro invalido";
+    case TSP_ERRO_MEMORIA:
+      return "Memoria insuficiente";
+  }//switch
+  return "Erro desconhecido";
+}//tspMensagemErro
+
+
+#ifndef TSP_BIBLIOTECA
+/**
+ * @brief Retorna o índice da melhor rota do conjunto elite de uma instância residente
+ *
+ * @param residente instância residente
+ * @return int índice da melhor rota (-1 se não houver rotas)
+ */
+static int melhorResidente(InstanciaResidente *residente){
+  int melhor = -1;
+
+  for (int i = 0; i < residente->qtdElite; i++){
+    if (melhor == -1 || residente->eliteDist[i] < residente->eliteDist[melhor]){
+      melhor = i;
+    }//if
+  }//for
+
+  return melhor;
+}//melhorResidente
+
+/**
+ * @brief Localiza uma instância no cache do servidor, carregando-a se necessário
+ *
+ * Ao carregar, a instância é lida uma única vez e a grade, o grafo candidato e
+ * o solver são construídos e mantidos em memória para as próximas requisições.
+ *
+ * @param cache vetor de instâncias residentes
+ * @param qtdCache quantidade de instâncias no cache
+ * @param arquivo caminho do arquivo .tsp
+ * @return InstanciaResidente* instância residente (NULL se o arquivo não puder ser lido)
+ */
+static InstanciaResidente *obtemResidente(InstanciaResidente ***cache, int *qtdCache, char *arquivo){
+  InstanciaResidente *residente;
+
+  for (int i = 0; i < *qtdCache; i++){
+    if (strcmp((*cache)[i]->arquivo, arquivo) == 0){
+      return (*cache)[i];
+    }//if
+  }//for
+
+  residente = (InstanciaResidente *)calloc(1, sizeof(InstanciaResidente));
+  // Um arquivo inválido não pode derrubar o servidor
+  if (!lerInstancia(arquivo, false, &residente->instance)){
+    free(residente);
+    return NULL;
+  }//if
+  residente->arquivo = strdup(arquivo);
+  residente->area = criaAreaTrabalho(residente->instance.dimension);
+  if (residente->area == NULL ||
+      tspCriaSolver((float *)residente->instance.nodes, residente->instance.dimension, &residente->solver) != TSP_OK){
+    liberaAreaTrabalho(residente->area);
+    liberaInstancia(residente->instance);
+    free(residente->arquivo);
+    free(residente);
+    return NULL;
+  }//if
+  residente->k = residente->instance.dimension - 1 < CANDIDATOS ? residente->instance.dimension - 1 : CANDIDATOS;
+  residente->grade = construirGrade(residente->instance);
+  residente->candidatos = construirCandidatos(residente->instance, residente->grade, residente->k);
+  for (int i = 0; i < GPX_ELITE; i++){
+    residente->elite[i] = (int *)malloc(residente->instance.dimension * sizeof(int));
+  }//for
+
+  *cache = (InstanciaResidente **)realloc(*cache, (*qtdCache + 1) * sizeof(InstanciaResidente *));
+  (*cache)[(*qtdCache)++] = residente;
+  return residente;
+}//obtemResidente
+
+/**
+ * @brief Executa GRASP+2opt sobre uma instância residente e guarda o resultado no conjunto elite
+ *
+ * @param residente instância residente
+ * @param tempoLimite orçamento em segundos (0 = uma execução por thread)
+ * @param sementeBase semente da primeira thread
+ * @param threads quantidade de threads
+ * @param iteracoes quantidade de iterações executadas
+ * @return TspStatus resultado do solver
+ */
+static TspStatus resolveResidente(InstanciaResidente *residente, double tempoLimite, unsigned int sementeBase, int threads, int *iteracoes){
+  TspOpcoes opcoes;
+  TspResultado resultado;
+  TspStatus status;
+
+  tspOpcoesPadrao(&opcoes);
+  opcoes.threads = threads;
+  opcoes.tempoLimite = tempoLimite;
+  opcoes.semente = sementeBase;
+
+  resultado.rota = (int *)malloc(residente->instance.dimension * sizeof(int));
+  status = tspResolve(residente->solver, &opcoes, &resultado);
+  if (status == TSP_OK){
+    *iteracoes = resultado.iteracoes;
+    insereElite(residente->instance, residente->elite, residente->eliteDist, &residente->qtdElite, resultado.rota, resultado.distancia);
+    recombinaElite(residente->instance, residente->elite, residente->eliteDist, &residente->qtdElite, resultado.rota, residente->area);
+  }//if
+  free(resultado.rota);
+
+  return status;
+}//resolveResidente
+
+/**
+ * @brief Custo das arestas que tocam as posições p e q da rota (cada aresta uma vez)
+ */
+static double custoArestasTroca(Instance instance, int *rota, int n, int p, int q){
+  int arestas[4] = {(p - 1 + n) % n, p, (q - 1 + n) % n, q}; // Posição inicial de cada aresta
+  double custo = 0;
+  bool repetida;
+
+  for (int a = 0; a < 4; a++){
+    repetida = false;
+    for (int b = 0; b < a; b++){
+      repetida = repetida || arestas[b] == arestas[a];
+    }//for
+    if (!repetida){
+      custo += distance(rota[arestas[a]], rota[(arestas[a] + 1) % n], instance);
+    }//if
+  }//for
+  return custo;
+}//custoArestasTroca
+
+/**
+ * @brief Copia os trechos registrados de uma rota para outra
+ *
+ * @param destino rota que recebe os trechos
+ * @param origem rota de onde os trechos são copiados
+ * @param n tamanho das rotas
+ * @param trechos trechos alterados
+ * @param qtdTrechos quantidade de trechos (acima de TRECHOS_MAX copia a rota inteira)
+ * @param pos posições dos vértices de destino a serem atualizadas (ou NULL)
+ */
+static void copiaTrechos(int *destino, int *origem, int n, Trecho *trechos, int qtdTrechos, int *pos){
+  int i;
+
+  if (qtdTrechos > TRECHOS_MAX){
+    memcpy(destino, origem, n * sizeof(int));
+    for (i = 0; i < n && pos != NULL; i++){
+      pos[destino[i]] = i;
+    }//for
+    return;
+  }//if
+  for (int t = 0; t < qtdTrechos; t++){
+    for (int j = 0; j < trechos[t].tamanho; j++){
+      i = (trechos[t].inicio + j) % n;
+      destino[i] = origem[i];
+      if (pos != NULL){
+        pos[destino[i]] = i;
+      }//if
+    }//for
+  }//for
+}//copiaTrechos
+
+/**
+ * @brief Tarefa de melhoria: perturba a melhor rota com trocas aleatórias e aplica o 2opt
+ *
+ * A rota corrente, as posições e a fila do 2opt são mantidas entre as
+ * iterações: o custo é acompanhado pelas variações das trocas e dos
+ * movimentos, e apenas os trechos alterados são copiados para a melhor rota
+ * (se a perturbação melhorou) ou restaurados a partir dela. Cada iteração
+ * custa proporcionalmente aos trechos alterados; as inversões do 2opt sobre
+ * o vetor ainda podem chegar a meia rota.
+ *
+ * @param arg TarefaMelhoria a ser executada
+ */
+static void executaTarefaMelhoria(void *arg){
+  TarefaMelhoria *tarefa = (TarefaMelhoria *)arg;
+  Instance instance = tarefa->instance;
+  AreaTrabalho *area = tarefa->areas[trabalhadorAtual];
+  int n = instance.dimension;
+  int *rota = area->rota;
+  int *pos = area->pos;
+  int *fila = area->fila;
+  bool *ativo = area->visitados; // Todo falso entre as iterações
+  Trecho trechos[TRECHOS_MAX];
+  int qtdTrechos, qtdFila, v;
+  int node[2];
+  double inicio = tempoAtual();
+  double variacao;
+
+  semente = tarefa->semente;
+  tarefa->iteracoes = 0;
+  memcpy(tarefa->melhorRota, tarefa->rotaInicial, n * sizeof(int));
+  memcpy(rota, tarefa->rotaInicial, n * sizeof(int));
+  for (int i = 0; i < n; i++){
+    pos[rota[i]] = i;
+  }//for
+  memset(ativo, 0, n * sizeof(bool));
+
+  do
+  {
+    // Perturba a melhor rota, que é igual à rota corrente no início da iteração
+    qtdTrechos = 0;
+    qtdFila = 0;
+    variacao = 0;
+    for (int j = 0; j < 3; j++){
+      node[0] = aleatorio() % n;
+      node[1] = aleatorio() % n;
+      variacao -= custoArestasTroca(instance, rota, n, node[0], node[1]);
+      v = rota[node[0]];
+      rota[node[0]] = rota[node[1]];
+      rota[node[1]] = v;
+      pos[rota[node[0]]] = node[0];
+      pos[rota[node[1]]] = node[1];
+      variacao += custoArestasTroca(instance, rota, n, node[0], node[1]);
+      // Registra as posições trocadas e ativa os vértices trocados e os seus vizinhos na rota
+      for (int e = 0; e < 2; e++){
+        trechos[qtdTrechos].inicio = node[e];
+        trechos[qtdTrechos++].tamanho = 1;
+        for (int t = -1; t <= 1; t++){
+          v = rota[(node[e] + t + n) % n];
+          if (!ativo[v]){
+            ativo[v] = true;
+            fila[qtdFila++] = v;
+          }//if
+        }//for
+      }//for
+    }//for
+
+    variacao += buscaVizinhanca(instance, rota, pos, tarefa->candidatos, tarefa->k, ativo, fila, qtdFila, trechos, &qtdTrechos);
+    if (variacao < -0.001){
+      copiaTrechos(tarefa->melhorRota, rota, n, trechos, qtdTrechos, NULL);
+    }else{
+      copiaTrechos(rota, tarefa->melhorRota, n, trechos, qtdTrechos, pos);
+    }//else
+    tarefa->iteracoes++;
+  } while (tempoAtual() - inicio < tarefa->tempoLimite);
+
+  normalizaRota(tarefa->melhorRota, n);
+  tarefa->distancia = fitness(instance, tarefa->melhorRota);
+}//executaTarefaMelhoria
+
+/**
+ * @brief Garante que as áreas de trabalho dos trabalhadores comportem a instância
+ *
+ * Áreas já grandes o suficiente são reaproveitadas; as menores são recriadas.
+ *
+ * @param areas uma área por trabalhador (NULL enquanto não criada)
+ * @param qtd quantidade de trabalhadores
+ * @param dimensao dimensão da instância
+ * @return bool false se faltar memória
+ */
+static bool preparaAreas(AreaTrabalho **areas, int qtd, int dimensao){
+  for (int i = 0; i < qtd; i++){
+    if (areas[i] == NULL || areas[i]->dimensao < dimensao){
+      liberaAreaTrabalho(areas[i]);
+      areas[i] = criaAreaTrabalho(dimensao);
+      if (areas[i] == NULL){
+        return false;
+      }//if
+    }//if
+  }//for
+  return true;
+}//preparaAreas
+
+/**
+ * @brief Melhora a melhor rota residente por perturbação + 2opt em várias threads
+ *
+ * @param residente instância residente (com pelo menos uma rota no conjunto elite)
+ * @param tempoLimite orçamento em segundos
+ * @param sementeBase semente da primeira thread
+ * @param threads quantidade de threads
+ * @param areas áreas de trabalho dos trabalhadores (preparadas para a instância)
+ * @return int quantidade de iterações executadas (-1 se faltar memória)
+ */
+static int melhoraResidente(InstanciaResidente *residente, double tempoLimite, unsigned int sementeBase, int threads, AreaTrabalho **areas){
+  int n = residente->instance.dimension;
+  TarefaMelhoria *tarefas = (TarefaMelhoria *)calloc(threads, sizeof(TarefaMelhoria));
+  PoolTrabalho *pool = criaPool(threads, threads);
+  int *rotaInicial = (int *)malloc(n * sizeof(int));
+  int iteracoes = 0;
+
+  if (tarefas == NULL || pool == NULL || rotaInicial == NULL){
+    iteracoes = -1;
+  }//if
+  for (int i = 0; i < threads && iteracoes == 0; i++){
+    tarefas[i].melhorRota = (int *)malloc(n * sizeof(int));
+    if (tarefas[i].melhorRota == NULL){
+      iteracoes = -1;
+    }//if
+  }//for
+  if (iteracoes == 0){
+    memcpy(rotaInicial, residente->elite[melhorResidente(residente)], n * sizeof(int));
+  }//if
+  for (int i = 0; i < threads && iteracoes == 0; i++){
+    tarefas[i].instance = residente->instance;
+    tarefas[i].rotaInicial = rotaInicial;
+    tarefas[i].candidatos = residente->candidatos;
+    tarefas[i].k = residente->k;
+    tarefas[i].areas = areas;
+    tarefas[i].tempoLimite = tempoLimite;
+    tarefas[i].semente = sementeBase + i;
+    submetePool(pool, executaTarefaMelhoria, &tarefas[i]);
+  }//for
+  if (iteracoes == 0 && !executaPool(pool)){
+    iteracoes = -1;
+  }//if
+
+  for (int i = 0; i < threads && iteracoes >= 0; i++){
+    iteracoes += tarefas[i].iteracoes;
+    insereElite(residente->instance, residente->elite, residente->eliteDist, &residente->qtdElite, tarefas[i].melhorRota, tarefas[i].distancia);
+  }//for
+  if (iteracoes >= 0){
+    recombinaElite(residente->instance, residente->elite, residente->eliteDist, &residente->qtdElite, rotaInicial, residente->area);
+  }//if
+
+  for (int i = 0; i < threads && tarefas != NULL; i++){
+    free(tarefas[i].melhorRota);
+  }//for
+  if (pool != NULL){
+    liberaPool(pool);
+  }//if
+  free(rotaInicial);
+  free(tarefas);
+  return iteracoes;
+}//melhoraResidente
+
+/**
+ * @brief Envia ao cliente a melhor rota residente (vértices numerados a partir de 1)
+ *
+ * @param saida conexão com o cliente
+ * @param residente instância residente
+ * @param iteracoes iterações executadas na requisição
+ * @param tempo tempo gasto na requisição
+ */
+static void enviaRotaResidente(FILE *saida, InstanciaResidente *residente, int iteracoes, double tempo){
+  int melhor = melhorResidente(residente);
+  int *rota = residente->elite[melhor];
+
+  fprintf(saida, "OK %d %f %d %.3f\n", residente->instance.dimension, residente->eliteDist[melhor], iteracoes, tempo);
+  fprintf(saida, "1\n");
+  for (int i = 0; i < residente->instance.dimension - 1; i++){
+    fprintf(saida, "%d\n", rota[i] + 1);
+  }//for
+  fprintf(saida, "-1\n");
+}//enviaRotaResidente
+
+/**
+ * @brief Executa o modo servidor, atendendo requisições em um socket Unix local
+ *
+ * As instâncias, os grafos candidatos e as melhores rotas ficam em memória
+ * entre as requisições. Cada linha recebida é um comando:
+ *   SOLVE <arquivo .tsp> <segundos> [semente]  GRASP+2opt; responde a melhor rota residente
+ *   IMPROVE <arquivo .tsp> <segundos> [semente]  perturbação+2opt a partir da melhor rota
+ *   BOUND <arquivo .tsp>  limite inferior e gap da melhor rota
+ *   STATUS  instâncias residentes
+ *   SHUTDOWN  encerra o servidor
+ * As respostas começam com OK ou ERRO. Sem a semente, ela é derivada da
+ * quantidade de requisições já atendidas para a instância.
+ *
+ * @param caminhoSocket caminho do socket
+ * @param threads quantidade de threads usadas em cada requisição
+ */
+static void executaServidor(char *caminhoSocket, int threads){
+  struct sockaddr_un endereco;
+  InstanciaResidente **cache = NULL;
+  InstanciaResidente *residente;
+  AreaTrabalho **areas;
+  int qtdCache = 0;
+  int servidor, cliente, iteracoes, melhoradas, melhor;
+  bool ativo = true;
+  char linha[400];
+  char comando[20];
+  char arquivo[300];
+  double segundos, inicio;
+  unsigned int sementeReq;
+  int lidos;
+  TspStatus status;
+  FILE *entrada, *saida;
+
+  if (threads < 1 || strlen(caminhoSocket) >= sizeof(endereco.sun_path)){
+    printf("Erro: parâmetros inválidos para o servidor\n");
+    exit(1);
+  }//if
+
+  // Áreas dos trabalhadores, mantidas entre as requisições
+  areas = (AreaTrabalho **)calloc(threads, sizeof(AreaTrabalho *));
+  signal(SIGPIPE, SIG_IGN);
+  servidor = socket(AF_UNIX, SOCK_STREAM, 0);
+  memset(&endereco, 0, sizeof(endereco));
+  endereco.sun_family = AF_UNIX;
+  strcpy(endereco.sun_path, caminhoSocket);
+  unlink(caminhoSocket);
+  if (servidor < 0 || bind(servidor, (struct sockaddr *)&endereco, sizeof(endereco)) < 0 || listen(servidor, 8) < 0){
+    perror("Erro ao criar o socket:");
+    exit(1);
+  }//if
+  printf("Servidor aguardando em %s com %d threads\n", caminhoSocket, threads);
+  fflush(stdout);
+
+  while (ativo && (cliente = accept(servidor, NULL, NULL)) >= 0){
+    entrada = fdopen(cliente, "r");
+    saida = fdopen(dup(cliente), "w");
+
+    while (ativo && fgets(linha, sizeof(linha), entrada) != NULL){
+      lidos = sscanf(linha, "%19s %299s %lf %u", comando, arquivo, &segundos, &sementeReq);
+      if (lidos < 3) segundos = 0;
+      inicio = tempoAtual();
+
+      if (lidos >= 1 && strcmp(comando, "STATUS") == 0){
+        fprintf(saida, "OK %d\n", qtdCache);
+        for (int i = 0; i < qtdCache; i++){
+          melhor = melhorResidente(cache[i]);
+          fprintf(saida, "%s %d %f %d\n", cache[i]->arquivo, cache[i]->instance.dimension,
+                  melhor == -1 ? INFINITY : cache[i]->eliteDist[melhor], cache[i]->qtdElite);
+        }//for
+      }else if (lidos >= 1 && strcmp(comando, "SHUTDOWN") == 0){
+        fprintf(saida, "OK\n");
+        ativo = false;
+      }else if (lidos >= 2 && (strcmp(comando, "SOLVE") == 0 || strcmp(comando, "IMPROVE") == 0 || strcmp(comando, "BOUND") == 0)){
+        residente = obtemResidente(&cache, &qtdCache, arquivo);
+        if (residente == NULL){
+          fprintf(saida, "ERRO arquivo invalido: %s\n", arquivo);
+        }else if (segundos < 0){
+          fprintf(saida, "ERRO %s\n", tspMensagemErro(TSP_ERRO_PARAMETRO));
+        }else{
+          // Sem semente, cada requisição continua a busca com sementes novas
+          if (lidos < 4) sementeReq = 1 + residente->requisicoes * threads;
+          residente->requisicoes++;
+          iteracoes = 0;
+          status = TSP_OK;
+          // IMPROVE e BOUND precisam de uma rota inicial
+          if (strcmp(comando, "SOLVE") == 0 || residente->qtdElite == 0){
+            status = resolveResidente(residente, strcmp(comando, "SOLVE") == 0 ? segundos : 0, sementeReq, threads, &iteracoes);
+          }//if
+          if (status != TSP_OK){
+            // Sem rota residente não há o que melhorar nem avaliar
+            fprintf(saida, "ERRO %s\n", tspMensagemErro(status));
+          }else if (strcmp(comando, "IMPROVE") == 0 && !preparaAreas(areas, threads, residente->instance.dimension)){
+            fprintf(saida, "ERRO %s\n", tspMensagemErro(TSP_ERRO_MEMORIA));
+          }else if (strcmp(comando, "BOUND") == 0){
+            melhor = melhorResidente(residente);
+            if (residente->limite == 0){
+              residente->limite = limiteInferior(residente->instance, residente->grade, residente->candidatos,
+                                                 residente->k, residente->eliteDist[melhor]);
+            }//if
+            fprintf(saida, "OK %f %.2f%%\n", residente->limite,
+                    100 * (residente->eliteDist[melhor] - residente->limite) / residente->limite);
+          }else{
+            melhoradas = strcmp(comando, "IMPROVE") == 0 ? melhoraResidente(residente, segundos, sementeReq, threads, areas) : 0;
+            if (melhoradas < 0){
+              fprintf(saida, "ERRO %s\n", tspMensagemErro(TSP_ERRO_MEMORIA));
+            }else{
+              enviaRotaResidente(saida, residente, iteracoes + melhoradas, tempoAtual() - inicio);
+            }//else
+          }//else
+        }//else
       }else{
-        fprintf(logFile,",%f", distancia);// demais colunas
+        fprintf(saida, "ERRO comando invalido\n");
       }//else
-      fflush(logFile);
-      
-    }//forAlpha
-    fprintf(logFile,"\n" );
-  } // forExecutions
+      fflush(saida);
+    }//while
+
+    fclose(entrada);
+    fclose(saida);
+  }//while
+
+  close(servidor);
+  unlink(caminhoSocket);
+
+  for (int i = 0; i < qtdCache; i++){
+    for (int j = 0; j < GPX_ELITE; j++){
+      free(cache[i]->elite[j]);
+    }//for
+    tspLiberaSolver(cache[i]->solver);
+    liberaAreaTrabalho(cache[i]->area);
+    liberaGrade(cache[i]->grade);
+    free(cache[i]->candidatos);
+    liberaInstancia(cache[i]->instance);
+    free(cache[i]->arquivo);
+    free(cache[i]);
+  }//for
+  free(cache);
+  for (int i = 0; i < threads; i++){
+    liberaAreaTrabalho(areas[i]);
+  }//for
+  free(areas);
+}//executaServidor
 
-  //Fecha arquivo de log
-  fclose(logFile);
-}
+
+/**
+ * @brief Executa o reparo incremental de uma rota após a atualização da instância
+ *
+ * As estrelas da instância antiga são associadas às da nova pela posição (a
+ * estrela mais próxima na grade, até a tolerância). Estrelas sem
+ * correspondência são retiradas da rota; estrelas novas (ou que se moveram
+ * além da tolerância) são inseridas pela inserção mais barata entre seus
+ * vizinhos candidatos. Por fim, o 2opt é aplicado apenas a partir das
+ * estrelas inseridas e das vizinhas das removidas.
+ *
+ * @param arquivoAntigo instância original (.tsp)
+ * @param arquivoRota rota da instância original (.tour)
+ * @param arquivoNovo instância atualizada (.tsp)
+ * @param tolerancia distância máxima para considerar a mesma estrela
+ */
+static void reparaRota(char *arquivoAntigo, char *arquivoRota, char *arquivoNovo, float tolerancia){
+  double inicio = tempoAtual();
+  Instance antiga = readTspFile(arquivoAntigo, false);
+  Instance nova = readTspFile(arquivoNovo, false);
+  int n = nova.dimension;
+  int *rotaAntiga = (int *)malloc(antiga.dimension * sizeof(int));
+  int *mapa = (int *)malloc(antiga.dimension * sizeof(int));
+  int *proximo = (int *)malloc(n * sizeof(int));
+  int *anterior = (int *)malloc(n * sizeof(int));
+  bool *naRota = (bool *)calloc(n, sizeof(bool));
+  bool *ativo = (bool *)calloc(n, sizeof(bool));
+  int *rota = (int *)malloc(n * sizeof(int));
+  int k = n - 1 < CANDIDATOS ? n - 1 : CANDIDATOS;
+  int vizinho, primeiro = -1, ultimo = -1, mantidas = 0, inseridas = 0;
+  int u, melhorU;
+  float dist, custo, melhorCusto, distanciaInsercao, distancia;
+  bool lacuna = false;
+  Grade grade;
+  int *candidatos;
+
+  if (n < 3 || lerTour(arquivoRota, antiga.dimension, rotaAntiga) != antiga.dimension){
+    printf("Erro: a rota %s não corresponde à instância %s\n", arquivoRota, arquivoAntigo);
+    exit(1);
+  }//if
+
+  grade = construirGrade(nova);
+  candidatos = construirCandidatos(nova, grade, k);
+
+  // Associa cada estrela antiga à estrela mais próxima da nova instância
+  for (int i = 0; i < antiga.dimension; i++){
+    mapa[i] = -1;
+    if (vizinhosProximos(nova, grade, antiga.nodes[i], -1, 1, &vizinho, &dist) == 1 &&
+        dist <= tolerancia * tolerancia && !naRota[vizinho]){
+      mapa[i] = vizinho;
+      naRota[vizinho] = true;
+    }//if
+  }//for
+
+  // Percorre a rota antiga mantendo as estrelas associadas; as vizinhas de
+  // estrelas removidas ficam ativas para a busca local
+  for (int i = 0; i < antiga.dimension; i++){
+    u = mapa[rotaAntiga[i]];
+    if (u == -1){
+      lacuna = true;
+      if (ultimo != -1) ativo[ultimo] = true;
+      continue;
+    }//if
+    if (ultimo == -1){
+      primeiro = u;
+    }else{
+      proximo[ultimo] = u;
+      anterior[u] = ultimo;
+    }//else
+    if (lacuna){
+      ativo[u] = true;
+      lacuna = false;
+    }//if
+    ultimo = u;
+    mantidas++;
+  }//for
+  if (lacuna && primeiro != -1){
+    ativo[primeiro] = true;
+  }//if
+  if (primeiro == -1){ // Nenhuma estrela mantida: começa pela estrela 0
+    primeiro = ultimo = 0;
+    naRota[0] = true;
+    ativo[0] = true;
+    mantidas = 0;
+    inseridas++;
+  }//if
+  proximo[ultimo] = primeiro;
+  anterior[primeiro] = ultimo;
+
+  // Inserção mais barata das estrelas novas ao lado de um vizinho candidato
+  for (int s = 0; s < n; s++){
+    if (naRota[s]){
+      continue;
+    }//if
+    melhorCusto = INFINITY;
+    melhorU = -1;
+    for (int j = 0; j < k; j++){
+      vizinho = candidatos[(size_t)s * k + j];
+      if (!naRota[vizinho]) continue;
+      for (int lado = 0; lado < 2; lado++){
+        u = lado == 0 ? vizinho : anterior[vizinho];
+        custo = distance(u, s, nova) + distance(s, proximo[u], nova) - distance(u, proximo[u], nova);
+        if (custo < melhorCusto){
+          melhorCusto = custo;
+          melhorU = u;
+        }//if
+      }//for
+    }//for
+    // Nenhum vizinho candidato na rota: procura em toda a rota
+    if (melhorU == -1){
+      u = primeiro;
+      do
+      {
+        custo = distance(u, s, nova) + distance(s, proximo[u], nova) - distance(u, proximo[u], nova);
+        if (custo < melhorCusto){
+          melhorCusto = custo;
+          melhorU = u;
+        }//if
+        u = proximo[u];
+      } while (u != primeiro);
+    }//if
+
+    proximo[s] = proximo[melhorU];
+    anterior[proximo[melhorU]] = s;
+    proximo[melhorU] = s;
+    anterior[s] = melhorU;
+    naRota[s] = true;
+    ativo[s] = true;
+    inseridas++;
+  }//for
+
+  // Converte a lista ligada em vetor com a estrela 0 na última posição
+  u = proximo[0];
+  for (int i = 0; i < n; i++){
+    rota[i] = u;
+    u = proximo[u];
+  }//for
+
+  distanciaInsercao = fitness(nova, rota);
+  // A lista ligada não é mais usada: proximo e anterior servem de vetores de trabalho
+  distancia = run2optVizinhanca(nova, rota, candidatos, k, ativo, proximo, anterior);
+
+  printf("Estrelas mantidas: %d, removidas: %d, inseridas: %d\n", mantidas, antiga.dimension - mantidas, inseridas);
+  printf("Distancia apos insercao: %f\n", distanciaInsercao);
+  printf("Distancia apos 2opt local: %f\n", distancia);
+  printf("Tempo: %.2lfs\n", tempoAtual() - inicio);
+  saveTour(nova, rota);
+
+  liberaGrade(grade);
+  free(candidatos);
+  free(rotaAntiga);
+  free(mapa);
+  free(proximo);
+  free(anterior);
+  free(naRota);
+  free(ativo);
+  free(rota);
+  liberaInstancia(antiga);
+  liberaInstancia(nova);
+}//reparaRota
 
 
 int main(int argc, char **argv)
 {
-  srand(1);
+  semente = 1;
   int execucoes;
   int base;
-
-  if (argc == 3){// Verifica se os argumentos foram passados
+  float gapAlvo = 0;
+
+  if ((argc == 3 || argc == 4) && strcmp(argv[1], "-b") == 0){// Modo lote
+    executaLote(argv[2], argc == 4 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN));
+    return 0;
+  }else if ((argc == 3 || argc == 4) && strcmp(argv[1], "-s") == 0){// Modo servidor
+    executaServidor(argv[2], argc == 4 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN));
+    return 0;
+  }else if ((argc == 5 || argc == 6) && strcmp(argv[1], "-r") == 0){// Reparo incremental
+    reparaRota(argv[2], argv[3], argv[4], argc == 6 ? atof(argv[5]) : 0.001);
+    return 0;
+  }else if (argc == 3 || argc == 4){// Verifica se os argumentos foram passados
     execucoes = atoi(argv[2]);
     base = atoi(argv[1]);
+    if(argc == 4){
+      gapAlvo = atof(argv[3]);
+    }//if
     if(execucoes < 0){ //
       printf("Erro: O número de execuções não pode ser negativa!\n");
       exit(1);
@@ -794,11 +3610,15 @@ int main(int argc, char **argv)
       printf("Erro: A instancia escolhida deve estar entre 0 e 5\n");
       exit(1);
     }
+    if(gapAlvo < 0){
+      printf("Erro: O gap alvo não pode ser negativo!\n");
+      exit(1);
+    }//if
   }else{ // Exibe instruções caso não receber os parâmetros
     printf("Heuristicas TSP usando GRASP+2opt\n");
     printf("Autor: Muriel de Souza Godoi\n\n");
     printf("Para utilizar esse sistema execute com os parâmetros:\n");
-    printf("\n./tsp <instancia> <qte de execuções> (linux)\n");
+    printf("\n./tsp <instancia> <qte de execuções> [gap alvo %%] (linux)\n");
     printf("As instancias devem estar entre 0 e 5\n\n");
     printf("Instancia 0 ->     100 estrelas\n");
     printf("Instancia 1 ->   1.000 estrelas\n");
@@ -806,6 +3626,14 @@ int main(int argc, char **argv)
     printf("Instancia 3 ->  37.859 estrelas\n");
     printf("Instancia 4 -> 109.399 estrelas\n");
     printf("Instancia 5 -> 250.000 estrelas\n\n");
+    printf("Gap alvo (opcional): encerra quando a distância da melhor rota\n");
+    printf("ao limite inferior for menor que o percentual informado\n\n");
+    printf("Modo lote:\n./tsp -b <manifesto> [threads]\n");
+    printf("Cada linha do manifesto: <arquivo .tsp> <semente> <execuções> <orçamento em segundos>\n\n");
+    printf("Modo servidor:\n./tsp -s <socket> [threads]\n");
+    printf("Comandos: SOLVE|IMPROVE <arquivo .tsp> <segundos> [semente], BOUND <arquivo .tsp>, STATUS, SHUTDOWN\n\n");
+    printf("Reparo incremental de uma rota após atualizar a instância:\n");
+    printf("./tsp -r <antigo .tsp> <antigo .tour> <novo .tsp> [tolerancia]\n\n");
 
     exit(1);
   }//else
@@ -821,24 +3649,44 @@ int main(int argc, char **argv)
   float distanciaGrasp;
   float minDistancia = INFINITY;
   float minGrasp = INFINITY;
-
-  Instance instance = readTspFile(dataSets[base], false);
-
-  int* melhorRota = (int*) malloc(instance.dimension * sizeof(int));
+  float limite = 0;
+  float gap = INFINITY;
+  Grade grade;
+  int *candidatos;
+  int k;
+
+  char arquivo[120];
+  sprintf(arquivo,"data/%s",dataSets[base]);
+  Instance instance = readTspFile(arquivo, false);
+
+  // Área de trabalho: nenhum vetor é alocado dentro do laço de execuções
+  AreaTrabalho *area = criaAreaTrabalho(instance.dimension);
+  if (area == NULL){
+    printf("Erro: memória insuficiente para a instancia\n");
+    exit(1);
+  }//if
+  rota = area->rota;
+  int* melhorRota = area->melhorRota;
   // displayInstance(instance);
 
+  // Conjunto elite utilizado na recombinação GPX
+  int* elite[GPX_ELITE];
+  float eliteDist[GPX_ELITE];
+  int qtdElite = 0;
+  for (int i = 0; i < GPX_ELITE; i++){
+    elite[i] = (int*) malloc(instance.dimension * sizeof(int));
+  }//for
+
   for (int i = 1; i <= execucoes; i++)
   {
-    free(rota);
-
     loopStartTick = clock();
-    //rota = geraRotaAleatoria(instance.dimension);
-    //rota = geraRotaGulosa(instance);
+    //geraRotaAleatoriaEm(instance.dimension, rota);
+    //geraRotaGulosaEm(instance, rota, area->visitados);
     
     if(i == 1){ //Executa uma vez com a busca 100% gulosa
-      rota = geraRotaGrasp(instance, 0);
+      geraRotaGraspEm(instance, 0, rota, area->visitados, area->lrc);
     }else{
-      rota = geraRotaGrasp(instance, 0.01 + (rand()%5) * 0.01);
+      geraRotaGraspEm(instance, 0.01 + (aleatorio()%5) * 0.01, rota, area->visitados, area->lrc);
     }//else
     
     distancia = fitness(instance, rota);
@@ -860,12 +3708,63 @@ int main(int argc, char **argv)
       memcpy(melhorRota,rota,instance.dimension * sizeof(int));
       saveTour(instance,melhorRota);
     }
-    printf("%.1lfs - 2OPT= %f - BG: %f - BL: %f\n", calculaTempo(initialTick),  distancia, minGrasp, minDistancia);
+
+    //Calcula o limite inferior utilizando a primeira rota como limite superior
+    if (i == 1){
+      k = instance.dimension - 1 < CANDIDATOS ? instance.dimension - 1 : CANDIDATOS;
+      grade = construirGrade(instance);
+      candidatos = construirCandidatos(instance, grade, k);
+      limite = limiteInferior(instance, grade, candidatos, k, distancia);
+    }//if
+    gap = 100 * (minDistancia - limite) / limite;
+
+    printf("%.1lfs - 2OPT= %f - BG: %f - BL: %f - LB: %f - GAP: %.2f%%\n", calculaTempo(initialTick),  distancia, minGrasp, minDistancia, limite, gap);
     fflush(stdout);
 
+    //Recombina periodicamente as melhores rotas encontradas
+    insereElite(instance, elite, eliteDist, &qtdElite, rota, distancia);
+    if (i % GPX_PERIODO == 0 && qtdElite > 1){
+      distancia = recombinaElite(instance, elite, eliteDist, &qtdElite, rota, area);
+      if (distancia < minDistancia)
+      {
+        printf("GPX melhorou: de %f para %f\n", minDistancia, distancia);
+        minDistancia = distancia;
+        memcpy(melhorRota,rota,instance.dimension * sizeof(int));
+        saveTour(instance,melhorRota);
+        gap = 100 * (minDistancia - limite) / limite;
+      }
+    }//if
+
+    //Encerra ao atingir o gap alvo
+    if (gapAlvo > 0 && gap <= gapAlvo){
+      printf("Gap alvo de %.2f%% atingido\n", gapAlvo);
+      break;
+    }//if
+
   } // forExecutions
 
+  //Pós-otimização exata da melhor rota por janelas deslizantes
+  if (execucoes > 0){
+    distancia = runJanelaDP(instance, melhorRota, JANELA_DP, (int)sysconf(_SC_NPROCESSORS_ONLN));
+    if (distancia < 0){
+      printf("Aviso: memória insuficiente para a pós-otimização exata\n");
+    }else if (distancia < minDistancia - 0.001){
+      printf("Janela DP melhorou: de %f para %f\n", minDistancia, distancia);
+      minDistancia = distancia;
+      saveTour(instance,melhorRota);
+      gap = 100 * (minDistancia - limite) / limite;
+    }//if
+  }//if
+
   printf("\nDistancia Minima: %f\n", minDistancia);
+  if (execucoes > 0){
+    printf("Limite Inferior: %f\n", limite);
+    printf("Gap: %.2f%%\n", gap);
+    liberaGrade(grade);
+    free(candidatos);
+  }//if
+  liberaAreaTrabalho(area);
 
   return 0;
-} // main method
\ No newline at end of file
+} // main method
+#endif // TSP_BIBLIOTECA
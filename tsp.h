@@ -0,0 +1,103 @@
+/**
+ * @file tsp.h
+ * @author Muriel de Souza Godoi (muriel@utfpr.edu.br)
+ * @brief API da biblioteca de heurísticas TSP (GRASP + busca local 2opt)
+ *
+ * Permite resolver instâncias em memória, sem arquivos .tsp/.tour. As
+ * coordenadas pertencem ao chamador e não são copiadas; a biblioteca nunca
+ * encerra o processo e reporta os erros pelo TspStatus retornado.
+ * O cabeçalho pode ser incluído diretamente em código C++.
+ *
+ * Compilação: make libtsp.a
+ */
+
+#ifndef TSP_H
+#define TSP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+  TSP_OK = 0,
+  TSP_ERRO_PARAMETRO,
+  TSP_ERRO_MEMORIA
+} TspStatus;
+
+typedef enum
+{
+  TSP_CONSTRUCAO_GRASP,
+  TSP_CONSTRUCAO_GULOSA,
+  TSP_CONSTRUCAO_ALEATORIA
+} TspConstrucao;
+
+typedef enum
+{
+  TSP_BUSCA_2OPT_FIRST,
+  TSP_BUSCA_2OPT_BEST,
+  TSP_BUSCA_NENHUMA
+} TspBuscaLocal;
+
+typedef struct
+{
+  TspConstrucao construcao;
+  TspBuscaLocal buscaLocal;
+  float alpha;         // Alpha máximo sorteado na construção GRASP
+  int threads;         // Threads executando reinícios independentes
+  int execucoes;       // Máximo de reinícios (0 = sem limite)
+  double tempoLimite;  // Tempo máximo em segundos (0 = sem limite; ver tspResolve)
+  unsigned int semente;
+  int janela;          // Pós-otimização exata por janelas deslizantes (0 = desligada, 3 a 12)
+} TspOpcoes;
+
+typedef struct
+{
+  int *rota;           // Fornecida pelo chamador, com espaço para dimensao vértices
+  float distancia;
+  int iteracoes;
+  double tempo;
+} TspResultado;
+
+typedef struct TspSolver TspSolver;
+
+/**
+ * @brief Preenche as opções com os valores padrão (GRASP + 2opt First, 1 thread)
+ *
+ * execucoes e tempoLimite começam em 0: basta definir tempoLimite para que
+ * os reinícios continuem até o tempo acabar.
+ */
+void tspOpcoesPadrao(TspOpcoes *opcoes);
+
+/**
+ * @brief Cria um solver sobre coordenadas x,y,z contíguas (3 floats por vértice)
+ *
+ * O vetor de coordenadas não é copiado e deve permanecer válido até tspLiberaSolver.
+ * Coordenadas não finitas (NaN ou infinito) resultam em TSP_ERRO_PARAMETRO.
+ */
+TspStatus tspCriaSolver(const float *coordenadas, int dimensao, TspSolver **solver);
+
+/**
+ * @brief Executa a heurística e grava em resultado a melhor rota encontrada
+ *
+ * A busca termina ao atingir execucoes reinícios ou tempoLimite segundos, o
+ * que ocorrer primeiro; um valor 0 não limita. Se execucoes e tempoLimite
+ * forem 0, é feita uma única execução por thread.
+ */
+TspStatus tspResolve(TspSolver *solver, const TspOpcoes *opcoes, TspResultado *resultado);
+
+/**
+ * @brief Libera o solver (as coordenadas do chamador não são liberadas)
+ */
+void tspLiberaSolver(TspSolver *solver);
+
+/**
+ * @brief Retorna a descrição de um código de erro
+ */
+const char *tspMensagemErro(TspStatus status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TSP_H